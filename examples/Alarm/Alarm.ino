@@ -0,0 +1,56 @@
+#include "RTC.h"
+#include "Alarm.h"
+
+// Software Real-Time Clock
+RTC rtc;
+
+// Alarm scheduler
+Alarm::Scheduler scheduler;
+
+// Alarm that prints a message and the time
+class Message : public Alarm {
+public:
+  Message(const __FlashStringHelper* name) : m_name(name) {}
+
+  virtual void run()
+  {
+    struct tm now;
+    char buf[32];
+    rtc.get_time(now);
+    Serial.print(isotime_r(&now, buf));
+    Serial.print(':');
+    Serial.println(m_name);
+  }
+
+protected:
+  const __FlashStringHelper* m_name;
+};
+
+Message every10s(F("every 10 seconds"));
+Message daily(F("daily at 00:01"));
+Message weekly(F("weekly on sunday at 00:02"));
+Message once(F("once after 5 seconds"));
+
+void setup()
+{
+  Serial.begin(57600);
+  while (!Serial);
+
+  // Start the clock just before midnight, Saturday, Jan 1, 2000
+  struct tm now(SATURDAY, 2000, JANUARY, 1, 23, 59, 30);
+  rtc.set_time(now);
+
+  // Schedule alarms relative to the current time
+  time_t time = rtc.get_time();
+  scheduler.every(every10s, 10, time);
+  scheduler.daily(daily, 0, 1, time);
+  scheduler.weekly(weekly, SUNDAY, 0, 2, time);
+  scheduler.at(once, time + 5);
+}
+
+void loop()
+{
+  // Dispatch due alarms once per second; only the first alarm is
+  // checked when there is nothing to do
+  if (rtc.tick()) scheduler.dispatch(rtc.get_time());
+}
@@ -0,0 +1,45 @@
+#include "RTC.h"
+#include "TWI.h"
+#include "Hardware/TWI.h"
+#include "Driver/DS1307.h"
+
+// Asynchronous read of DS1307; requires the hardware TWI
+Hardware::TWI twi(100000UL);
+DS1307 rtc(twi);
+
+// Number of loop iterations during the transfer
+uint16_t count = 0;
+
+void completed(DS1307* rtc, bool status)
+{
+  struct tm now;
+  char buf[32];
+  Serial.print(millis() / 1000.0);
+  Serial.print(':');
+  Serial.print(count);
+  Serial.print(F(":\""));
+  if (status && rtc->get_time_result(now))
+    Serial.print(isotime_r(&now, buf));
+  Serial.println('"');
+}
+
+void setup()
+{
+  Serial.begin(57600);
+  while (!Serial);
+}
+
+void loop()
+{
+  static uint32_t start = 0;
+
+  // Start a new read once per second
+  if (millis() - start >= 1000) {
+    start = millis();
+    count = 0;
+    rtc.get_time_async(completed);
+  }
+
+  // Advance the transfer; other work may be done in the loop
+  if (rtc.poll() == 0) count += 1;
+}
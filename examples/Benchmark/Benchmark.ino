@@ -0,0 +1,199 @@
+#include "RTC.h"
+#include "Hardware/AVR/eu_dst.h"
+#include "Hardware/AVR/usa_dst.h"
+#include "Hardware/AVR/zones.h"
+
+// Number of calls per measurement
+const uint16_t COUNT = 1000;
+
+// Number of random time stamps (power of 2)
+const uint8_t SAMPLES = 32;
+
+// Random time stamps from epoch
+time_t sample[SAMPLES];
+
+// Compiled time zone rule; Central European Time
+zone_t zone;
+
+// Prevent the compiler from removing the measured calls
+volatile uint8_t sink;
+volatile time_t result_time;
+
+void result(const __FlashStringHelper* name, uint32_t us)
+{
+  Serial.print(name);
+  Serial.print(F(": "));
+  Serial.print((float) us / COUNT, 2);
+  Serial.print(F(" us, "));
+  Serial.print((COUNT * 1000000.0) / us, 0);
+  Serial.println(F(" calls/s"));
+}
+
+void setup()
+{
+  Serial.begin(57600);
+  while (!Serial);
+
+  // Set Central European Time Zone: UTC+01:00 with Daylight Saving
+  set_zone(ONE_HOUR);
+  set_dst(eu_dst);
+  zone_init_P(&zone, &zone_cet);
+
+  // Generate random time stamps over the full range
+  randomSeed(analogRead(0));
+  for (uint8_t i = 0; i < SAMPLES; i++)
+    sample[i] = ((uint32_t) random(0x10000) << 16) | random(0x10000);
+}
+
+void loop()
+{
+  uint32_t start, us;
+  uint8_t value;
+  struct tm now;
+  time_t time;
+  char buf[32];
+
+  // BCD conversion; arithmetic and table lookup
+  value = 0;
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++) {
+    sink = bcd_t::encode(value);
+    if (++value == 100) value = 0;
+  }
+  us = micros() - start;
+  result(F("bcd_t::encode"), us);
+
+  value = 0;
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++) {
+    sink = bcd_t::encode_table(value);
+    if (++value == 100) value = 0;
+  }
+  us = micros() - start;
+  result(F("bcd_t::encode_table"), us);
+
+  value = 0;
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++) {
+    sink = bcd_t::decode(value);
+    value += 1;
+  }
+  us = micros() - start;
+  result(F("bcd_t::decode"), us);
+
+  // BCD block conversion of clock/calender registers
+  uint8_t reg[7] = { 30, 59, 23, 31, 12, 7, 99 };
+  bcd_t rtc[7];
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++) {
+    bcd_t::encode(rtc, reg, sizeof(reg));
+    sink = bcd_t::decode(reg, rtc, sizeof(reg));
+  }
+  us = micros() - start;
+  result(F("bcd_t::encode/decode[7]"), us);
+
+  // Time conversion; sequential time stamps
+  time = sample[0];
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++, time++)
+    gmtime_r(&time, &now);
+  us = micros() - start;
+  result(F("gmtime_r(sequential)"), us);
+
+  time = sample[0];
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++, time++)
+    localtime_r(&time, &now);
+  us = micros() - start;
+  result(F("localtime_r(sequential)"), us);
+
+  // Time of day field extraction; random time stamps
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++)
+    sink = hour(sample[i & (SAMPLES - 1)]);
+  us = micros() - start;
+  result(F("hour(random)"), us);
+
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++)
+    sink = weekday(sample[i & (SAMPLES - 1)]);
+  us = micros() - start;
+  result(F("weekday(random)"), us);
+
+  // Time conversion; random time stamps
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++)
+    gmtime_r(&sample[i & (SAMPLES - 1)], &now);
+  us = micros() - start;
+  result(F("gmtime_r(random)"), us);
+
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++)
+    localtime_r(&sample[i & (SAMPLES - 1)], &now);
+  us = micros() - start;
+  result(F("localtime_r(random)"), us);
+
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++)
+    localtime_z(&sample[i & (SAMPLES - 1)], &now, &zone);
+  us = micros() - start;
+  result(F("localtime_z(random)"), us);
+
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++) {
+    int32_t zone = ONE_HOUR;
+    sink = eu_dst(&sample[i & (SAMPLES - 1)], &zone);
+  }
+  us = micros() - start;
+  result(F("eu_dst(random)"), us);
+
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++, time++) {
+    int32_t zone = -5 * ONE_HOUR;
+    sink = usa_dst(&time, &zone);
+  }
+  us = micros() - start;
+  result(F("usa_dst(sequential)"), us);
+
+  gmtime_r(&sample[0], &now);
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++)
+    result_time = mk_gmtime(&now);
+  us = micros() - start;
+  result(F("mk_gmtime"), us);
+
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++) {
+    now.tm_isdst = -1;
+    result_time = mktime(&now);
+  }
+  us = micros() - start;
+  result(F("mktime"), us);
+
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++)
+    sink = *isotime_r(&now, buf);
+  us = micros() - start;
+  result(F("isotime_r"), us);
+
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++)
+    sink = isotime_len(&now, buf);
+  us = micros() - start;
+  result(F("isotime_len"), us);
+
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++)
+    sink = strftime(buf, sizeof(buf), "%F %T", &now);
+  us = micros() - start;
+  result(F("strftime(%F %T)"), us);
+
+  start = micros();
+  for (uint16_t i = 0; i < COUNT; i++)
+    sink = (isotime_parse(buf, &time, NULL) != NULL);
+  us = micros() - start;
+  result(F("isotime_parse"), us);
+
+  Serial.println();
+  delay(5000);
+}
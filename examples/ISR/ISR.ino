@@ -0,0 +1,43 @@
+#include "RTC.h"
+
+// Software Real-Time Clock advanced by Timer1 compare match interrupt
+RTC rtc;
+
+ISR(TIMER1_COMPA_vect)
+{
+  rtc.tick_isr();
+}
+
+void setup()
+{
+  Serial.begin(57600);
+  while (!Serial);
+
+  // Set Central European Time Zone: UTC+01:00
+  set_zone(ONE_HOUR);
+
+  // Timer1: CTC mode, prescale 256, compare match once per second
+  TCCR1A = 0;
+  TCCR1B = _BV(WGM12) | _BV(CS12);
+  TCNT1 = 0;
+  OCR1A = (F_CPU / 256) - 1;
+  TIMSK1 = _BV(OCIE1A);
+}
+
+void loop()
+{
+  static time_t prev = 0;
+  struct tm now;
+
+  // Wait for the next second; no polling of the clock is needed
+  time_t time = rtc.get_time();
+  if (time == prev) return;
+  prev = time;
+
+  // Stream time in ISO format; no intermediate buffer
+  rtc.get_time(now);
+  Serial.print(millis() / 1000.0);
+  Serial.print(F(":\""));
+  strftime(Serial, F("%F %T"), &now);
+  Serial.println('"');
+}
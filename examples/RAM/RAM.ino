@@ -1,8 +1,13 @@
 #include "GPIO.h"
 #include "RTC.h"
+#include "RAMCache.h"
 #include "Driver/DS1302.h"
 
-DS1302<BOARD::D11, BOARD::D12, BOARD::D13> rtc;
+typedef DS1302<BOARD::D11, BOARD::D12, BOARD::D13> Device;
+Device rtc;
+
+// Write-back cache of device memory
+RAMCache<Device> cache(rtc);
 
 void setup()
 {
@@ -18,6 +23,17 @@ void setup()
     Serial.print(F("  "));
   }
   Serial.println();
+
+  // Cached single byte writes; written with one burst on flush
+  cache.begin();
+  for (size_t i = 0; i < cache.RAM_MAX; i++)
+    cache.write_ram(i, cache.read_ram(i) * 2);
+  cache.flush();
+  for (size_t i = 0; i < rtc.RAM_MAX; i++) {
+    Serial.print(rtc.read_ram(i));
+    Serial.print(F("  "));
+  }
+  Serial.println();
 }
 
 void loop()
@@ -10,7 +10,13 @@
 #if defined(USE_DS1302)
 #include "GPIO.h"
 #include "Driver/DS1302.h"
+// Configure: DS1302 transport (software or hardware SPI)
+// #define USE_HARDWARE_SPI
+#if defined(USE_HARDWARE_SPI)
+DS1302Driver< DS1302SPI<BOARD::D10> > rtc;
+#else
 DS1302<BOARD::D11, BOARD::D12, BOARD::D13> rtc;
+#endif
 
 #elif defined(USE_DS1307)
 #include "TWI.h"
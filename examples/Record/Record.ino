@@ -0,0 +1,52 @@
+#include "RTC.h"
+#include "Record.h"
+
+// Configure: Use DS1302 or DS1307
+// #define USE_DS1302
+#define USE_DS1307
+
+#if defined(USE_DS1302)
+#include "GPIO.h"
+#include "Driver/DS1302.h"
+typedef DS1302<BOARD::D11, BOARD::D12, BOARD::D13> Device;
+Device rtc;
+#else
+#include "TWI.h"
+#include "Hardware/TWI.h"
+#include "Driver/DS1307.h"
+typedef DS1307 Device;
+Hardware::TWI twi(100000UL);
+Device rtc(twi);
+#endif
+
+// Persistent state in device memory
+struct state_t {
+  uint16_t boots;		// Number of restarts
+  uint32_t uptime;		// Seconds since first start
+};
+
+Record<Device, state_t> state(rtc, Device::RAM_START);
+
+void setup()
+{
+  Serial.begin(57600);
+  while (!Serial);
+
+  // Restore latest valid state; new state on first start
+  if (!state.begin()) Serial.println(F("no valid record"));
+  state.data().boots += 1;
+  state.commit();
+  Serial.print(F("boots="));
+  Serial.println(state.data().boots);
+}
+
+void loop()
+{
+  // Only the changed bytes are written on commit
+  delay(1000);
+  state.data().uptime += 1;
+  state.commit();
+  Serial.print(state.sequence());
+  Serial.print(F(":uptime="));
+  Serial.println(state.data().uptime);
+}
@@ -0,0 +1,201 @@
+/**
+ * @file benchmark.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+#include "Hardware/AVR/eu_dst.h"
+#include "Hardware/AVR/usa_dst.h"
+#include "Hardware/AVR/zones.h"
+#include "ref.h"
+#include <stdio.h>
+
+/**
+ * Host benchmark of the time and BCD conversion functions. Each
+ * function is called over a set of sequential and a set of random
+ * time stamps. The result is the time per call (ns) and calls per
+ * second.
+ */
+
+// Number of time stamps per set (power of 2)
+static const uint32_t SAMPLES = 1UL << 20;
+
+// Number of passes over the set
+static const uint8_t PASSES = 8;
+
+// Sequential and random time stamps from epoch
+static time_t sequential[SAMPLES];
+static time_t random_time[SAMPLES];
+
+// Broken-down time and ISO 8601 string of the random time stamps
+static struct tm random_tm[SAMPLES];
+static char random_iso[SAMPLES][20];
+
+// Clock registers (BCD) of the random time stamps
+static bcd_t random_bcd[SAMPLES][7];
+
+// Compiled time zone rule; Central European Time
+static zone_t zone;
+
+// Prevent the compiler from removing the measured calls
+static volatile uint32_t sink;
+
+/**
+ * Return next pseudo-random number (xorshift32).
+ * @return random number.
+ */
+static uint32_t next()
+{
+  static uint32_t x = 2463534242UL;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return (x);
+}
+
+/**
+ * Print benchmark result.
+ * @param[in] name of function.
+ * @param[in] set name of time stamp set.
+ * @param[in] start time (ns).
+ */
+static void result(const char* name, const char* set, uint64_t start)
+{
+  double ns = (double) (host_nanos() - start) / ((double) SAMPLES * PASSES);
+  printf("%-24s %-12s %8.2f ns %14.0f calls/s\n", name, set, ns, 1e9 / ns);
+}
+
+/**
+ * Benchmark the given function over the given time stamps.
+ * @param[in] name of function.
+ * @param[in] set name of time stamp set.
+ * @param[in] time time stamps.
+ * @param[in] fn function.
+ */
+template<typename FN>
+static void run(const char* name, const char* set, const time_t* time, FN fn)
+{
+  uint64_t start = host_nanos();
+  for (uint8_t pass = 0; pass < PASSES; pass++)
+    for (uint32_t i = 0; i < SAMPLES; i++)
+      sink = fn(time[i]);
+  result(name, set, start);
+}
+
+/**
+ * Benchmark the given function over sequential and random time
+ * stamps.
+ * @param[in] name of function.
+ * @param[in] fn function.
+ */
+template<typename FN>
+static void run(const char* name, FN fn)
+{
+  run(name, "sequential", sequential, fn);
+  run(name, "random", random_time, fn);
+}
+
+int main()
+{
+  // Set Central European Time Zone: UTC+01:00 with Daylight Saving
+  set_zone(ONE_HOUR);
+  set_dst(eu_dst);
+  zone_init_P(&zone, &zone_cet);
+
+  // Sequential time stamps from 2017 and random over the full range
+  for (uint32_t i = 0; i < SAMPLES; i++) {
+    sequential[i] = 536457600UL + i;
+    random_time[i] = next();
+#if TIME_64
+    random_time[i] &= 0xffffffffUL;
+#endif
+    gmtime_r(&random_time[i], &random_tm[i]);
+    isotime_r(&random_tm[i], random_iso[i]);
+    const struct tm& now = random_tm[i];
+    const uint8_t regs[7] = {
+      (uint8_t) now.tm_sec, (uint8_t) now.tm_min, (uint8_t) now.tm_hour,
+      (uint8_t) (now.tm_wday + 1), (uint8_t) now.tm_mday,
+      (uint8_t) (now.tm_mon + 1), (uint8_t) (now.tm_year % 100)
+    };
+    bcd_t::encode(random_bcd[i], regs, 7);
+  }
+
+  run("gmtime_r", [](time_t time) {
+      struct tm now;
+      gmtime_r(&time, &now);
+      return (now.tm_sec);
+    });
+  run("ref_gmtime", [](time_t time) {
+      ref_tm_t now;
+      ref_gmtime(time, &now);
+      return (now.sec);
+    });
+  run("localtime_r", [](time_t time) {
+      struct tm now;
+      localtime_r(&time, &now);
+      return (now.tm_sec);
+    });
+  run("localtime_z", [](time_t time) {
+      struct tm now;
+      localtime_z(&time, &now, &zone);
+      return (now.tm_sec);
+    });
+  run("eu_dst", [](time_t time) {
+      int32_t z = ONE_HOUR;
+      return (eu_dst(&time, &z));
+    });
+  run("usa_dst", [](time_t time) {
+      int32_t z = -5 * ONE_HOUR;
+      return (usa_dst(&time, &z));
+    });
+
+  // Conversion from broken-down time; random time stamps
+  uint32_t i = 0;
+  run("mk_gmtime", "random", random_time, [&](time_t) {
+      return (mk_gmtime(&random_tm[i++ & (SAMPLES - 1)]));
+    });
+  run("mktime", "random", random_time, [&](time_t) {
+      struct tm now = random_tm[i++ & (SAMPLES - 1)];
+      now.tm_isdst = -1;
+      return (mktime(&now));
+    });
+  run("isotime_r", "random", random_time, [&](time_t) {
+      char buf[32];
+      return (*isotime_r(&random_tm[i++ & (SAMPLES - 1)], buf));
+    });
+  run("isotime_parse", "random", random_time, [&](time_t) {
+      time_t time;
+      return (isotime_parse(random_iso[i++ & (SAMPLES - 1)], &time, NULL) != NULL);
+    });
+
+  // BCD conversion; table and arithmetic, and block decode of the
+  // clock registers with validity mask
+  run("bcd_t::encode", "random", random_time, [](time_t time) {
+      return (bcd_t::encode(time % 100));
+    });
+  run("bcd_t::encode_table", "random", random_time, [](time_t time) {
+      return (bcd_t::encode_table(time % 100));
+    });
+  run("bcd_t::decode", "random", random_time, [](time_t time) {
+      return (bcd_t::decode(time));
+    });
+  run("bcd_t::decode[7]", "random", random_time, [&](time_t) {
+      uint8_t dest[7];
+      uint8_t invalid = bcd_t::decode(dest, random_bcd[i++ & (SAMPLES - 1)], 7);
+      return (invalid + dest[0] + dest[6]);
+    });
+  return (0);
+}
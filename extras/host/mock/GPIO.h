@@ -0,0 +1,168 @@
+/**
+ * @file mock/GPIO.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef HOST_MOCK_GPIO_H
+#define HOST_MOCK_GPIO_H
+
+/**
+ * Board pins; digital pins of the Arduino Uno.
+ */
+namespace BOARD {
+  enum pin_t {
+    D0, D1, D2, D3, D4, D5, D6, D7, D8, D9,
+    D10, D11, D12, D13, D14, D15, D16, D17, D18, D19
+  };
+};
+
+/**
+ * Device connected to the host pins; notified of output pin changes
+ * and drives the input pins.
+ */
+struct host_gpio_device_t {
+  /**
+   * Pin data direction changed.
+   * @param[in] pin board pin.
+   * @param[in] output true(1) for output otherwise false(0).
+   */
+  virtual void mode(BOARD::pin_t pin, bool output) = 0;
+
+  /**
+   * Output pin changed.
+   * @param[in] pin board pin.
+   * @param[in] value new pin value.
+   */
+  virtual void write(BOARD::pin_t pin, bool value) = 0;
+
+  /**
+   * Return value driven by the device on the given input pin.
+   * @param[in] pin board pin.
+   * @return bool.
+   */
+  virtual bool read(BOARD::pin_t pin) = 0;
+};
+
+/**
+ * Return reference to the device connected to the host pins, or
+ * NULL for none.
+ * @return device.
+ */
+inline host_gpio_device_t*& host_gpio_device()
+{
+  static host_gpio_device_t* device = NULL;
+  return (device);
+}
+
+/**
+ * Host mock of the GPIO pin template class (Arduino-GPIO). Each pin
+ * access takes one cycle of host_cycles, and is passed to the
+ * connected device.
+ * @param[in] PIN board pin.
+ */
+template<BOARD::pin_t PIN>
+class GPIO {
+public:
+  /**
+   * Construct pin in input mode.
+   */
+  GPIO() :
+    m_value(false)
+  {}
+
+  /**
+   * Set pin to input mode.
+   */
+  void input()
+  {
+    mode(false);
+  }
+
+  /**
+   * Set pin to output mode.
+   */
+  void output()
+  {
+    mode(true);
+  }
+
+  /**
+   * Set pin high.
+   */
+  void high()
+  {
+    write(true);
+  }
+
+  /**
+   * Set pin low.
+   */
+  void low()
+  {
+    write(false);
+  }
+
+  /**
+   * Toggle pin.
+   */
+  void toggle()
+  {
+    write(!m_value);
+  }
+
+  /**
+   * Set pin to given value.
+   * @param[in] value to set.
+   * @return reference.
+   */
+  GPIO& operator=(bool value)
+  {
+    write(value);
+    return (*this);
+  }
+
+  /**
+   * Return value on pin; driven by the connected device.
+   * @return bool.
+   */
+  operator bool()
+  {
+    host_cycles += 1;
+    host_gpio_device_t* device = host_gpio_device();
+    return (device != NULL ? device->read(PIN) : m_value);
+  }
+
+protected:
+  /** Output value. */
+  bool m_value;
+
+  void mode(bool output)
+  {
+    host_cycles += 1;
+    host_gpio_device_t* device = host_gpio_device();
+    if (device != NULL) device->mode(PIN, output);
+  }
+
+  void write(bool value)
+  {
+    host_cycles += 1;
+    m_value = value;
+    host_gpio_device_t* device = host_gpio_device();
+    if (device != NULL) device->write(PIN, value);
+  }
+};
+
+#endif
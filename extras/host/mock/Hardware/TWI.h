@@ -0,0 +1,48 @@
+/**
+ * @file mock/Hardware/TWI.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef HOST_MOCK_HARDWARE_TWI_H
+#define HOST_MOCK_HARDWARE_TWI_H
+
+#include "TWI.h"
+
+namespace Hardware {
+
+/**
+ * Host mock of the hardware TWI bus manager (Arduino-TWI); the mock
+ * bus is attached as slave of the simulated TWI peripheral, and the
+ * bit rate register is set for the given frequency.
+ */
+class TWI : public ::TWI {
+public:
+  /**
+   * Construct hardware bus manager with the given bus frequency.
+   * @param[in] freq bus frequency (default 100 kHz).
+   */
+  TWI(uint32_t freq = 100000UL) :
+    ::TWI()
+  {
+    TWSR = 0;
+    TWBR = ((F_CPU / freq) - 16) / 2;
+    host_twi_slave = this;
+  }
+};
+
+};
+
+#endif
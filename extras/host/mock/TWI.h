@@ -0,0 +1,268 @@
+/**
+ * @file mock/TWI.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef HOST_MOCK_TWI_H
+#define HOST_MOCK_TWI_H
+
+#include <string.h>
+
+/** I/O vector for write of several buffers. */
+struct iovec_t {
+  void* buf;			//!< Buffer.
+  size_t size;			//!< Number of bytes.
+};
+
+/** Add buffer to I/O vector and step to next element. */
+#define iovec_arg(vp,b,n)						\
+  do {									\
+    (vp)->buf = (void*) (b);						\
+    (vp)->size = (n);							\
+    (vp)++;								\
+  } while (0)
+
+/** Mark end of I/O vector. */
+#define iovec_end(vp)							\
+  do {									\
+    (vp)->buf = 0;							\
+    (vp)->size = 0;							\
+  } while (0)
+
+/**
+ * Host mock of the TWI bus manager (Arduino-TWI) with a single
+ * slave; a register file with a register pointer that is set by the
+ * first byte written and incremented by each transfer, as DS1307.
+ * Transactions and bytes are counted, and a bus failure may be
+ * injected. The mock is also the slave of the simulated TWI
+ * peripheral; see Hardware::TWI.
+ */
+class TWI : public host_twi_slave_t {
+public:
+  /** Slave address. */
+  static const uint8_t SLAVE = 0x68;
+
+  /** Size of slave register file. */
+  static const uint8_t MEM_MAX = 64;
+
+  /**
+   * Construct bus with cleared slave register file.
+   */
+  TWI() :
+    transactions(0),
+    bytes(0),
+    fail(false),
+    m_ptr(0),
+    m_locked(false),
+    m_first(false)
+  {
+    memset(mem, 0, sizeof(mem));
+  }
+
+  /**
+   * Device on the bus; the driver interface of the bus manager.
+   */
+  class Device {
+  public:
+    /**
+     * Construct device with the given bus address.
+     * @param[in] twi bus manager.
+     * @param[in] addr device address.
+     */
+    Device(TWI& twi, uint8_t addr) :
+      m_twi(twi),
+      m_addr(addr)
+    {}
+
+  protected:
+    /** Bus manager. */
+    TWI& m_twi;
+
+    /** Device address. */
+    uint8_t m_addr;
+
+    bool acquire()
+    {
+      return (m_twi.acquire());
+    }
+
+    bool release()
+    {
+      return (m_twi.release());
+    }
+
+    int read(void* buf, size_t count)
+    {
+      return (m_twi.read(m_addr, buf, count));
+    }
+
+    int write(const void* buf, size_t count)
+    {
+      iovec_t vec[2];
+      iovec_t* vp = vec;
+      iovec_arg(vp, buf, count);
+      iovec_end(vp);
+      return (m_twi.write(m_addr, vec));
+    }
+
+    int write(iovec_t* vec)
+    {
+      return (m_twi.write(m_addr, vec));
+    }
+  };
+
+  /**
+   * Acquire the bus. Return true(1) if successful otherwise false(0);
+   * already acquired.
+   * @return bool.
+   */
+  bool acquire()
+  {
+    if (m_locked) return (false);
+    m_locked = true;
+    return (true);
+  }
+
+  /**
+   * Release the bus. Return true(1) if successful otherwise false(0);
+   * not acquired.
+   * @return bool.
+   */
+  bool release()
+  {
+    if (!m_locked) return (false);
+    m_locked = false;
+    return (true);
+  }
+
+  /**
+   * Return true(1) if the bus is acquired, otherwise false(0).
+   * @return bool.
+   */
+  bool is_locked() const
+  {
+    return (m_locked);
+  }
+
+  /**
+   * Read from the slave register file into the given buffer. Return
+   * number of bytes read or negative error code.
+   * @param[in] addr device address.
+   * @param[in] buf buffer.
+   * @param[in] count number of bytes.
+   * @return count or -1.
+   */
+  int read(uint8_t addr, void* buf, size_t count)
+  {
+    transactions += 1;
+    if (fail || addr != SLAVE) return (-1);
+    uint8_t* bp = (uint8_t*) buf;
+    for (size_t i = 0; i < count; i++) *bp++ = read();
+    bytes += count;
+    return (count);
+  }
+
+  /**
+   * Write the given I/O vector to the slave; the first byte is the
+   * register pointer. Return number of bytes written or negative
+   * error code.
+   * @param[in] addr device address.
+   * @param[in] vec I/O vector.
+   * @return count or -1.
+   */
+  int write(uint8_t addr, iovec_t* vec)
+  {
+    transactions += 1;
+    if (fail || addr != SLAVE) return (-1);
+    int count = 0;
+    m_first = true;
+    for (; vec->buf != 0; vec++) {
+      const uint8_t* bp = (const uint8_t*) vec->buf;
+      for (size_t i = 0; i < vec->size; i++) write(*bp++);
+      count += vec->size;
+    }
+    bytes += count;
+    return (count);
+  }
+
+  /** Slave register file. */
+  uint8_t mem[MEM_MAX];
+
+  /** Number of transactions. */
+  uint32_t transactions;
+
+  /** Number of bytes transferred. */
+  uint32_t bytes;
+
+  /** Fail transactions. */
+  bool fail;
+
+  /**
+   * Address condition from the simulated TWI peripheral.
+   */
+  virtual bool address(uint8_t sla)
+  {
+    transactions += 1;
+    m_first = true;
+    return (!fail && (sla >> 1) == SLAVE);
+  }
+
+  /**
+   * Write byte from the simulated TWI peripheral; the first byte
+   * after the address is the register pointer.
+   */
+  virtual bool write(uint8_t data)
+  {
+    if (m_first)
+      m_ptr = data % MEM_MAX;
+    else {
+      mem[m_ptr] = data;
+      m_ptr = (m_ptr + 1) % MEM_MAX;
+    }
+    m_first = false;
+    return (true);
+  }
+
+  /**
+   * Read byte at the register pointer to the simulated TWI
+   * peripheral.
+   */
+  virtual uint8_t read()
+  {
+    uint8_t data = mem[m_ptr];
+    m_ptr = (m_ptr + 1) % MEM_MAX;
+    return (data);
+  }
+
+  /**
+   * Stop condition from the simulated TWI peripheral.
+   */
+  virtual void stop()
+  {
+  }
+
+protected:
+  /** Register pointer. */
+  uint8_t m_ptr;
+
+  /** Bus acquired. */
+  bool m_locked;
+
+  /** Next written byte is the register pointer. */
+  bool m_first;
+};
+
+#endif
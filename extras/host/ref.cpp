@@ -0,0 +1,167 @@
+/**
+ * @file ref.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include <time.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <regex>
+#include <string>
+#include "ref.h"
+
+/** Seconds from the Unix epoch to the library epoch, 2000-01-01. */
+static const int64_t UNIX_OFFSET = 946684800LL;
+
+/**
+ * Copy the given C library broken-down time.
+ * @param[in] res C library broken-down time.
+ * @param[out] tm broken-down time.
+ */
+static void ref_tm(const struct tm* res, ref_tm_t* tm)
+{
+  tm->sec = res->tm_sec;
+  tm->min = res->tm_min;
+  tm->hour = res->tm_hour;
+  tm->mday = res->tm_mday;
+  tm->wday = res->tm_wday;
+  tm->mon = res->tm_mon;
+  tm->year = res->tm_year;
+  tm->yday = res->tm_yday;
+}
+
+void ref_gmtime(int64_t time, ref_tm_t* tm)
+{
+  time_t t = time + UNIX_OFFSET;
+  struct tm res;
+  gmtime_r(&t, &res);
+  ref_tm(&res, tm);
+}
+
+int64_t ref_timegm(const ref_tm_t* tm)
+{
+  struct tm res = {};
+  res.tm_sec = tm->sec;
+  res.tm_min = tm->min;
+  res.tm_hour = tm->hour;
+  res.tm_mday = tm->mday;
+  res.tm_mon = tm->mon;
+  res.tm_year = tm->year;
+  return (timegm(&res) - UNIX_OFFSET);
+}
+
+void ref_tz(const char* tz)
+{
+  static std::string current;
+  if (current == tz) return;
+  current = tz;
+  setenv("TZ", tz, 1);
+  tzset();
+}
+
+int ref_localtime(int64_t time, ref_tm_t* tm)
+{
+  time_t t = time + UNIX_OFFSET;
+  struct tm res;
+  localtime_r(&t, &res);
+  ref_tm(&res, tm);
+  return (res.tm_isdst > 0 ? res.tm_gmtoff + timezone : 0);
+}
+
+int64_t ref_mktime(const ref_tm_t* tm, int isdst)
+{
+  struct tm res = {};
+  res.tm_sec = tm->sec;
+  res.tm_min = tm->min;
+  res.tm_hour = tm->hour;
+  res.tm_mday = tm->mday;
+  res.tm_mon = tm->mon;
+  res.tm_year = tm->year;
+  res.tm_isdst = isdst;
+  return (mktime(&res) - UNIX_OFFSET);
+}
+
+size_t ref_strftime(char* buf, size_t size, const char* fmt,
+		    const ref_tm_t* tm)
+{
+  struct tm res = {};
+  res.tm_sec = tm->sec;
+  res.tm_min = tm->min;
+  res.tm_hour = tm->hour;
+  res.tm_mday = tm->mday;
+  res.tm_wday = tm->wday;
+  res.tm_mon = tm->mon;
+  res.tm_year = tm->year;
+  res.tm_yday = tm->yday;
+  return (strftime(buf, size, fmt, &res));
+}
+
+int ref_isotime_parse(const char* buf, ref_iso_t* iso)
+{
+  static const std::regex re("^(\\d{4})-(\\d{2})-(\\d{2})"
+			     "(?:[T ](\\d{2}):(\\d{2})"
+			     "(?::(\\d{2})(?:[.,](\\d+))?)?"
+			     "(Z|[+-]\\d{2}(?::?\\d{2})?)?)?");
+  std::cmatch m;
+  if (!std::regex_search(buf, m, re)) return (-1);
+  size_t n = m[0].length();
+  char next = buf[n];
+
+  // Strict parser; a separator, fraction or zone must be complete
+  if (!m[4].matched && (buf[10] == 'T' || buf[10] == ' ')) return (-1);
+  if (m[4].matched && !m[6].matched && !m[8].matched && next == ':')
+    return (-1);
+  if (!m[8].matched && m[6].matched && !m[7].matched
+      && (next == '.' || next == ',')) return (-1);
+  if (m[4].matched && !m[8].matched && (next == '+' || next == '-'))
+    return (-1);
+  if (m[8].matched && m[8].length() == 3
+      && (next == ':' || (next >= '0' && next <= '9'))) return (-1);
+
+  // Fields
+  ref_tm_t& tm = iso->tm;
+  tm.year = atoi(m[1].str().c_str()) - 1900;
+  tm.mon = atoi(m[2].str().c_str()) - 1;
+  tm.mday = atoi(m[3].str().c_str());
+  tm.hour = m[4].matched ? atoi(m[4].str().c_str()) : 0;
+  tm.min = m[5].matched ? atoi(m[5].str().c_str()) : 0;
+  tm.sec = m[6].matched ? atoi(m[6].str().c_str()) : 0;
+  iso->ms = m[7].matched ? atoi((m[7].str() + "00").substr(0, 3).c_str()) : 0;
+  iso->zone = m[8].matched;
+  iso->offset = 0;
+  if (iso->zone && m[8].str() != "Z") {
+    std::string z = m[8].str();
+    int hh = atoi(z.substr(1, 2).c_str());
+    int mm = z.size() > 3 ? atoi(z.substr(z.size() - 2).c_str()) : 0;
+    if (hh > 23 || mm > 59) return (-1);
+    iso->offset = (hh * 3600 + mm * 60) * (z[0] == '-' ? -1 : 1);
+  }
+  if (tm.mon < 0 || tm.mon > 11 || tm.hour > 23 || tm.min > 59
+      || tm.sec > 60) return (-1);
+
+  // Date must be valid; day of week and year from the C library
+  struct tm res = {};
+  res.tm_year = tm.year;
+  res.tm_mon = tm.mon;
+  res.tm_mday = tm.mday;
+  res.tm_hour = 12;
+  time_t t = timegm(&res);
+  gmtime_r(&t, &res);
+  if (tm.mday < 1 || res.tm_mday != tm.mday) return (-1);
+  tm.wday = res.tm_wday;
+  tm.yday = res.tm_yday;
+  return (n);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file ref.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef REF_H
+#define REF_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Reference functions from the C library for the host benchmark and
+ * tests. Time stamps are seconds from the library epoch, 2000-01-01.
+ */
+
+/** Broken-down time from the C library. */
+struct ref_tm_t {
+  int sec;			//!< Seconds [0-59].
+  int min;			//!< Minutes [0-59].
+  int hour;			//!< Hours [0-23].
+  int mday;			//!< Day in month [1-31].
+  int wday;			//!< Days since Sunday [0-6].
+  int mon;			//!< Months since January [0-11].
+  int year;			//!< Years since 1900.
+  int yday;			//!< Days since January 1 [0-365].
+};
+
+/**
+ * Convert the given time stamp to broken-down time with the C library
+ * gmtime_r().
+ * @param[in] time seconds from epoch.
+ * @param[out] tm broken-down time.
+ */
+void ref_gmtime(int64_t time, ref_tm_t* tm);
+
+/**
+ * Convert the given broken-down time to a time stamp with the C
+ * library timegm(). The fields are normalized.
+ * @param[in] tm broken-down time.
+ * @return seconds from epoch.
+ */
+int64_t ref_timegm(const ref_tm_t* tm);
+
+/**
+ * Set the time zone of the C library; a zone name, e.g.
+ * "Europe/Berlin", or a POSIX TZ string.
+ * @param[in] tz time zone.
+ */
+void ref_tz(const char* tz);
+
+/**
+ * Convert the given time stamp to broken-down local time in the time
+ * zone set with ref_tz(), with the C library localtime_r(). Return
+ * the Daylight Saving (seconds), zero for standard time.
+ * @param[in] time seconds from epoch.
+ * @param[out] tm broken-down time.
+ * @return seconds.
+ */
+int ref_localtime(int64_t time, ref_tm_t* tm);
+
+/**
+ * Convert the given broken-down local time in the time zone set with
+ * ref_tz() to a time stamp with the C library mktime().
+ * @param[in] tm broken-down time.
+ * @param[in] isdst Daylight Saving flag; negative if unknown.
+ * @return seconds from epoch.
+ */
+int64_t ref_mktime(const ref_tm_t* tm, int isdst);
+
+/**
+ * Format the given broken-down time with the C library strftime().
+ * The time is UTC; %s requires the time zone UTC0, see ref_tz().
+ * @param[out] buf buffer.
+ * @param[in] size of buffer.
+ * @param[in] fmt format string.
+ * @param[in] tm broken-down time.
+ * @return number of characters.
+ */
+size_t ref_strftime(char* buf, size_t size, const char* fmt,
+		    const ref_tm_t* tm);
+
+/** ISO 8601 fields from the reference parser. */
+struct ref_iso_t {
+  ref_tm_t tm;			//!< Date and time.
+  int ms;			//!< Milliseconds.
+  int offset;			//!< Zone offset (seconds East of UTC).
+  bool zone;			//!< Zone designator given.
+};
+
+/**
+ * Parse the given ISO 8601 string with a regular expression and
+ * check the fields with the C library; reference for isotime_parse().
+ * Return number of characters parsed, or -1 on error.
+ * @param[in] buf string to parse.
+ * @param[out] iso fields.
+ * @return number of characters or -1.
+ */
+int ref_isotime_parse(const char* buf, ref_iso_t* iso);
+
+#endif
@@ -0,0 +1,167 @@
+/**
+ * @file shim/avr/io.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+/** Bit value. */
+#define _BV(bit) (1 << (bit))
+
+/**
+ * Status register with the global interrupt flag. The interrupt
+ * instructions (cli, sei) in the library clear and set the flag. An
+ * interrupt raised with host_interrupt() while the flag is cleared
+ * is pending until the flag is set again; restore of the status
+ * register.
+ */
+struct host_sreg_t {
+  /** Status register; bit 7 is the global interrupt flag. */
+  volatile uint8_t value;
+
+  /**
+   * Return status register.
+   * @return value.
+   */
+  operator uint8_t() const
+  {
+    return (value);
+  }
+
+  /**
+   * Set status register and run pending interrupt if the global
+   * interrupt flag is set.
+   * @param[in] sreg new value.
+   * @return reference.
+   */
+  host_sreg_t& operator=(uint8_t sreg);
+};
+
+/** Global interrupt flag. */
+#define SREG_I 7
+
+extern host_sreg_t SREG;
+
+/**
+ * Raise interrupt with the given service routine. The routine is
+ * run with interrupts disabled, directly if the global interrupt
+ * flag is set, otherwise when it is set. May be called from a signal
+ * handler to interrupt the main program.
+ * @param[in] isr interrupt service routine.
+ */
+void host_interrupt(void (*isr)());
+
+/**
+ * Slave on the simulated TWI bus; called by the TWI peripheral for
+ * each bus step.
+ */
+struct host_twi_slave_t {
+  /**
+   * Address condition; return true(1) to acknowledge, otherwise
+   * false(0).
+   * @param[in] sla slave address and read/write bit.
+   * @return bool.
+   */
+  virtual bool address(uint8_t sla) = 0;
+
+  /**
+   * Data written by the master; return true(1) to acknowledge,
+   * otherwise false(0).
+   * @param[in] data byte.
+   * @return bool.
+   */
+  virtual bool write(uint8_t data) = 0;
+
+  /**
+   * Return data read by the master.
+   * @return byte.
+   */
+  virtual uint8_t read() = 0;
+
+  /** Stop condition. */
+  virtual void stop() = 0;
+};
+
+/**
+ * TWI control register of the simulated TWI peripheral. Writing
+ * with the interrupt flag set starts the bus step given by the
+ * control bits. The interrupt flag and status are set after
+ * host_twi_latency reads of the register; bus transfer time.
+ */
+struct host_twcr_t {
+  /** Control register. */
+  volatile uint8_t value;
+
+  /** Number of reads until the current bus step is completed. */
+  uint8_t pending;
+
+  /**
+   * Return control register.
+   * @return value.
+   */
+  operator uint8_t();
+
+  /**
+   * Set control register and start bus step.
+   * @param[in] twcr new value.
+   * @return reference.
+   */
+  host_twcr_t& operator=(uint8_t twcr);
+};
+
+/** TWI control register bits. */
+#define TWINT 7
+#define TWEA 6
+#define TWSTA 5
+#define TWSTO 4
+#define TWWC 3
+#define TWEN 2
+#define TWIE 0
+
+/** TWI status register prescaler bits. */
+#define TWPS1 1
+#define TWPS0 0
+
+extern host_twcr_t host_twcr;
+extern volatile uint8_t host_twsr;
+extern volatile uint8_t host_twdr;
+extern volatile uint8_t host_twbr;
+
+/** TWI registers. */
+#define TWCR host_twcr
+#define TWSR host_twsr
+#define TWDR host_twdr
+#define TWBR host_twbr
+
+/** Slave on the simulated TWI bus, or NULL for none. */
+extern host_twi_slave_t* host_twi_slave;
+
+/** Number of register reads per bus step (default 3). */
+extern uint8_t host_twi_latency;
+
+// The interrupt instructions operate on the status register
+#if defined(__x86_64__)
+__asm__(".macro cli\n\tandb $0x7f, SREG(%rip)\n.endm\n"
+	".macro sei\n\torb $0x80, SREG(%rip)\n.endm\n");
+#else
+__asm__(".macro cli\n.endm\n"
+	".macro sei\n.endm\n");
+#endif
+
+#endif
@@ -0,0 +1,131 @@
+/**
+ * @file shim/host.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include <time.h>
+#include <avr/io.h>
+
+uint32_t host_millis = 0;
+uint64_t host_cycles = 0;
+
+host_sreg_t SREG = { 1 << SREG_I };
+
+/** Pending interrupt service routine. */
+static void (* volatile pending)() = 0;
+
+/**
+ * Run the given interrupt service routine with interrupts disabled,
+ * and the pending interrupts raised while it ran.
+ * @param[in] isr interrupt service routine.
+ */
+static void run(void (*isr)())
+{
+  do {
+    SREG.value &= ~(1 << SREG_I);
+    isr();
+    SREG.value |= (1 << SREG_I);
+    isr = pending;
+    pending = 0;
+  } while (isr != 0);
+}
+
+host_sreg_t& host_sreg_t::operator=(uint8_t sreg)
+{
+  value = sreg;
+  if ((sreg & (1 << SREG_I)) && pending != 0) {
+    void (*isr)() = pending;
+    pending = 0;
+    run(isr);
+  }
+  return (*this);
+}
+
+void host_interrupt(void (*isr)())
+{
+  if (SREG.value & (1 << SREG_I))
+    run(isr);
+  else
+    pending = isr;
+}
+
+host_twcr_t host_twcr = { 0, 0 };
+volatile uint8_t host_twsr = 0xf8;
+volatile uint8_t host_twdr = 0xff;
+volatile uint8_t host_twbr = 0;
+host_twi_slave_t* host_twi_slave = 0;
+uint8_t host_twi_latency = 3;
+
+/** Bus state of the simulated TWI peripheral. */
+static enum { BUS_IDLE, BUS_ADDRESS, BUS_WRITE, BUS_READ } bus = BUS_IDLE;
+
+host_twcr_t::operator uint8_t()
+{
+  if (pending != 0 && --pending == 0) value |= _BV(TWINT);
+  return (value);
+}
+
+host_twcr_t& host_twcr_t::operator=(uint8_t twcr)
+{
+  uint8_t status;
+
+  // Stop condition is completed directly
+  if (twcr & _BV(TWSTO)) {
+    if (bus != BUS_IDLE && host_twi_slave != 0) host_twi_slave->stop();
+    bus = BUS_IDLE;
+    value = twcr & ~(_BV(TWSTO) | _BV(TWINT));
+    pending = 0;
+    TWSR = (TWSR & 0x03) | 0xf8;
+    return (*this);
+  }
+
+  // Writing the interrupt flag starts the next bus step
+  value = twcr & ~_BV(TWINT);
+  if ((twcr & _BV(TWINT)) == 0 || (twcr & _BV(TWEN)) == 0) return (*this);
+  if (twcr & _BV(TWSTA)) {
+    status = (bus == BUS_IDLE) ? 0x08 : 0x10;
+    bus = BUS_ADDRESS;
+  }
+  else if (bus == BUS_ADDRESS) {
+    bool read = (TWDR & 1);
+    bool ack = (host_twi_slave != 0 && host_twi_slave->address(TWDR));
+    if (read)
+      status = ack ? 0x40 : 0x48;
+    else
+      status = ack ? 0x18 : 0x20;
+    bus = read ? BUS_READ : BUS_WRITE;
+  }
+  else if (bus == BUS_WRITE) {
+    status = host_twi_slave->write(TWDR) ? 0x28 : 0x30;
+  }
+  else if (bus == BUS_READ) {
+    TWDR = host_twi_slave->read();
+    status = (twcr & _BV(TWEA)) ? 0x50 : 0x58;
+  }
+  else {
+    status = 0x00;
+  }
+  TWSR = (TWSR & 0x03) | status;
+  pending = host_twi_latency;
+  return (*this);
+}
+
+uint64_t host_nanos()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
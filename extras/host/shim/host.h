@@ -0,0 +1,86 @@
+/**
+ * @file shim/host.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef HOST_H
+#define HOST_H
+
+/**
+ * Arduino shim for building and testing the library on the host.
+ * Included by the Makefile before any other header. The system
+ * headers are included first, and the library time types and
+ * functions are then renamed so that they do not clash with the C
+ * library declarations.
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+#define time_t avr_time_t
+#define tm avr_tm
+#define timeval avr_timeval
+#define gmtime_r avr_gmtime_r
+#define localtime_r avr_localtime_r
+#define mktime avr_mktime
+#define difftime avr_difftime
+#define strftime avr_strftime
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+/** Select the AVR port of the library. */
+#ifndef AVR
+#define AVR 1
+#endif
+
+/** Milliseconds returned by millis(); advanced by the test. */
+extern uint32_t host_millis;
+
+/**
+ * Return milliseconds. Not advanced by the shim.
+ * @return milliseconds.
+ */
+inline uint32_t millis()
+{
+  return (host_millis);
+}
+
+/** Cycles passed to __builtin_avr_delay_cycles(). */
+extern uint64_t host_cycles;
+
+/**
+ * Count the given number of delay cycles.
+ * @param[in] cycles to delay.
+ */
+inline void host_delay_cycles(uint32_t cycles)
+{
+  host_cycles += cycles;
+}
+
+#define __builtin_avr_delay_cycles(cycles) host_delay_cycles(cycles)
+
+/**
+ * Return monotonic time in nanoseconds, for benchmarks.
+ * @return nanoseconds.
+ */
+uint64_t host_nanos();
+
+#endif
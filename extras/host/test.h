@@ -0,0 +1,70 @@
+/**
+ * @file test.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Checks and random numbers for the host tests. Each test is a
+ * single translation unit and includes this header once.
+ */
+
+/** Number of failed checks. */
+static uint32_t errors = 0;
+
+/** Number of checks. */
+static uint32_t checks = 0;
+
+/** Check the given condition; the first failures are printed. */
+#define CHECK(cond)							\
+  do {									\
+    checks++;								\
+    if (!(cond) && errors++ < 8)					\
+      printf("%s:%d: %s\n", __FILE__, __LINE__, #cond);			\
+  } while (0)
+
+/**
+ * Return next pseudo-random number (xorshift64).
+ * @return random number.
+ */
+static inline uint64_t next()
+{
+  static uint64_t x = 88172645463325252ULL;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  return (x);
+}
+
+/**
+ * Print the number of checks and errors of the given test. Return
+ * the exit status of the test; zero if there were no errors.
+ * @param[in] name of test.
+ * @return status.
+ */
+static inline int report(const char* name)
+{
+  printf("%s: %lu checks, %lu errors\n", name, (unsigned long) checks,
+	 (unsigned long) errors);
+  return (errors != 0);
+}
+
+#endif
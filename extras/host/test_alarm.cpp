@@ -0,0 +1,290 @@
+/**
+ * @file test_alarm.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+#include "Alarm.h"
+
+/**
+ * Test of the alarm scheduler; the software real-time clock is
+ * ticked each second over several months, and the alarms are
+ * dispatched each tick. Periodic, daily and weekly alarms are checked
+ * against the time each second, a chain of one-shot alarms with
+ * random intervals against the scheduled time, and missed periods
+ * after the clock is set forward.
+ */
+
+// Start; Saturday, December 31, 2016, 23:50:00
+static const struct tm START(SATURDAY, 2016, DECEMBER, 31, 23, 50, 0);
+
+// Number of days to tick
+static const uint16_t DAYS = 100;
+
+static uint32_t errors = 0;
+static uint32_t checks = 0;
+
+// Current time of the simulated clock
+static time_t now;
+
+/**
+ * Return next pseudo-random number (xorshift64).
+ * @return random number.
+ */
+static uint64_t next()
+{
+  static uint64_t x = 88172645463325252ULL;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  return (x);
+}
+
+/**
+ * Alarm that records the number of runs and the time of the latest
+ * run. The expected alarm times are given by is_due().
+ */
+class Check : public Alarm {
+public:
+  Check(const char* name) :
+    Alarm(),
+    m_name(name),
+    m_runs(0),
+    m_last(0)
+  {}
+
+  virtual void run()
+  {
+    m_runs += 1;
+    m_last = now;
+  }
+
+  /**
+   * Return true(1) if the alarm is expected to run at the given
+   * time, otherwise false(0).
+   * @param[in] time current time.
+   * @return bool.
+   */
+  virtual bool is_due(time_t time) = 0;
+
+  /**
+   * Check that the alarm ran at the current time if and only if
+   * expected.
+   */
+  void check()
+  {
+    checks++;
+    if (is_due(now) != (m_last == now) && errors++ < 8)
+      printf("%s: %lld, last %lld\n", m_name, (long long) now,
+	     (long long) m_last);
+  }
+
+  const char* m_name;
+  uint32_t m_runs;
+  time_t m_last;
+};
+
+/** Periodic alarm from the start time. */
+class Every : public Check {
+public:
+  Every(const char* name, uint32_t seconds, time_t start) :
+    Check(name),
+    m_seconds(seconds),
+    m_start(start)
+  {}
+
+  virtual bool is_due(time_t time)
+  {
+    return (time > m_start && (time - m_start) % m_seconds == 0);
+  }
+
+  uint32_t m_seconds;
+  time_t m_start;
+};
+
+/** Daily alarm; weekly when a day of week is given. */
+class Daily : public Check {
+public:
+  Daily(const char* name, uint8_t hour, uint8_t min, int8_t wday = -1) :
+    Check(name),
+    m_seconds(hour * 3600L + min * 60),
+    m_wday(wday)
+  {}
+
+  virtual bool is_due(time_t time)
+  {
+    return (time_of_day(time) == m_seconds
+	    && (m_wday < 0 || weekday(time) == m_wday));
+  }
+
+  uint32_t m_seconds;
+  int8_t m_wday;
+};
+
+/**
+ * One-shot alarm that schedules itself at a random time when run;
+ * the scheduler is called from the alarm action.
+ */
+class Chain : public Check {
+public:
+  Chain(Alarm::Scheduler& scheduler) :
+    Check("chain"),
+    m_scheduler(scheduler),
+    m_when(0),
+    m_prev(0)
+  {}
+
+  virtual void run()
+  {
+    Check::run();
+    m_prev = m_when;
+    m_when = now + 1 + next() % 20000;
+    m_scheduler.at(*this, m_when);
+  }
+
+  virtual bool is_due(time_t time)
+  {
+    return (time == m_when || time == m_prev);
+  }
+
+  Alarm::Scheduler& m_scheduler;
+  time_t m_when;
+  time_t m_prev;
+};
+
+int main()
+{
+  struct tm start = START;
+  Alarm::Scheduler scheduler;
+  RTC rtc;
+
+  rtc.set_time(start);
+  now = rtc.get_time();
+
+  Every second("every 1 s", 1, now);
+  Every seven("every 7 s", 7, now);
+  Every hour("every 1 h", 3600, now);
+  Every day("every 24 h", ONE_DAY, now);
+  Every cancelled("every 13 s", 13, now);
+  Daily midnight("daily 00:00", 0, 0);
+  Daily lunch("daily 12:34", 12, 34);
+  Daily late("daily 23:59", 23, 59);
+  Daily sunday("weekly sunday 00:02", 0, 2, SUNDAY);
+  Daily saturday("weekly saturday 23:59", 23, 59, SATURDAY);
+  Chain chain(scheduler);
+  Check* alarms[] = {
+    &second, &seven, &hour, &day, &cancelled, &midnight, &lunch,
+    &late, &sunday, &saturday, &chain
+  };
+
+  scheduler.every(second, 1, now);
+  scheduler.every(seven, 7, now);
+  scheduler.every(hour, 3600, now);
+  scheduler.every(day, ONE_DAY, now);
+  scheduler.every(cancelled, 13, now);
+  scheduler.daily(midnight, 0, 0, now);
+  scheduler.daily(lunch, 12, 34, now);
+  scheduler.daily(late, 23, 59, now);
+  scheduler.weekly(sunday, SUNDAY, 0, 2, now);
+  scheduler.weekly(saturday, SATURDAY, 23, 59, now);
+  chain.m_when = now + 5;
+  scheduler.at(chain, chain.m_when);
+
+  // Tick the clock and dispatch each second; the 13 s alarm is
+  // cancelled half way
+  for (uint32_t i = 0; i < DAYS * ONE_DAY; i++) {
+    host_millis += 1000;
+    if (!rtc.tick() && errors++ < 8) printf("tick: no increment\n");
+    now = rtc.get_time();
+    if (i == DAYS * ONE_DAY / 2) {
+      scheduler.cancel(cancelled);
+      cancelled.m_start = now + DAYS * ONE_DAY;
+    }
+    uint8_t count = scheduler.dispatch(now);
+    uint8_t expect = 0;
+    for (size_t j = 0; j < sizeof(alarms) / sizeof(alarms[0]); j++) {
+      alarms[j]->check();
+      if (alarms[j]->m_last == now) expect++;
+    }
+    checks++;
+    if (count != expect && errors++ < 8)
+      printf("dispatch(%lld): %u vs %u\n", (long long) now, count, expect);
+  }
+
+  // Number of runs
+  checks++;
+  if ((second.m_runs != DAYS * ONE_DAY
+       || hour.m_runs != DAYS * 24
+       || day.m_runs != DAYS
+       || midnight.m_runs != DAYS
+       || cancelled.m_runs != (DAYS * ONE_DAY / 2) / 13
+       || sunday.m_runs != (DAYS + 6) / 7
+       || chain.m_runs < DAYS * ONE_DAY / 20000)
+      && errors++ < 8)
+    printf("runs: %lu %lu %lu %lu %lu %lu\n",
+	   (unsigned long) second.m_runs, (unsigned long) hour.m_runs,
+	   (unsigned long) day.m_runs, (unsigned long) midnight.m_runs,
+	   (unsigned long) cancelled.m_runs, (unsigned long) sunday.m_runs);
+
+  // Set the clock forward; missed periods are run once, and the
+  // periodic alarms are rescheduled to the next period
+  rtc.set_time(now + 10 * ONE_DAY + 1234);
+  now = rtc.get_time();
+  scheduler.cancel(chain);
+  for (size_t j = 0; j < sizeof(alarms) / sizeof(alarms[0]); j++)
+    alarms[j]->m_runs = 0;
+  uint8_t count = scheduler.dispatch(now);
+  checks++;
+  if ((count != 9 || cancelled.m_runs != 0 || chain.m_runs != 0)
+      && errors++ < 8)
+    printf("set forward: %u alarms\n", count);
+  for (size_t j = 0; j < 4; j++) {
+    Every* alarm = (Every*) alarms[j];
+    checks++;
+    if ((alarm->m_runs != 1 || !alarm->is_scheduled()
+	 || alarm->when() <= now || alarm->when() > now + alarm->m_seconds
+	 || !alarm->is_due(alarm->when()))
+	&& errors++ < 8)
+      printf("%s: next %lld after set forward\n", alarm->m_name,
+	     (long long) alarm->when());
+  }
+  checks++;
+  if ((scheduler.dispatch(now) != 0
+       || scheduler.next() != second.when()
+       || midnight.when() != now - time_of_day(now) + (time_t) ONE_DAY)
+      && errors++ < 8)
+    printf("next: %lld\n", (long long) scheduler.next());
+
+  // Cancel of an alarm scheduled by another scheduler; no action
+  Alarm::Scheduler other;
+  scheduler.cancel(midnight);
+  other.daily(midnight, 0, 0, now);
+  scheduler.cancel(midnight);
+  checks++;
+  if ((!midnight.is_scheduled()
+       || other.next() != midnight.when()
+       || scheduler.next() != second.when())
+      && errors++ < 8)
+    printf("cancel: alarm of other scheduler\n");
+  other.cancel(midnight);
+  checks++;
+  if ((midnight.is_scheduled() || other.next() != 0) && errors++ < 8)
+    printf("cancel: alarm not removed\n");
+
+  printf("alarm: %lu checks, %lu errors\n", (unsigned long) checks,
+	 (unsigned long) errors);
+  return (errors != 0);
+}
@@ -0,0 +1,120 @@
+/**
+ * @file test_bcd.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+#include "test.h"
+
+/**
+ * Exhaustive test of the BCD conversion; arithmetic and table
+ * encode of 0..99, decode of valid values, validity check of all
+ * byte values and the invalid value mask of block decode.
+ */
+
+/**
+ * Return true(1) if both nibbles of the given byte are decimal
+ * digits, otherwise false(0).
+ * @param[in] value byte.
+ * @return bool.
+ */
+static bool valid(uint8_t value)
+{
+  return (((value >> 4) < 10) && ((value & 0x0f) < 10));
+}
+
+/**
+ * Return block of BCD values with the given raw bytes.
+ * @param[out] dest BCD values.
+ * @param[in] src raw bytes.
+ * @param[in] count number of values.
+ */
+static void raw(bcd_t* dest, const uint8_t* src, uint8_t count)
+{
+  memcpy(dest, src, count);
+}
+
+int main()
+{
+  // Encode 0..99; arithmetic and table, and round trip
+  for (uint8_t value = 0; value < 100; value++) {
+    uint8_t bcd = ((value / 10) << 4) | (value % 10);
+    CHECK(bcd_t::encode(value) == bcd);
+    CHECK(bcd_t::encode_table(value) == bcd);
+    CHECK(bcd_t::decode(bcd) == value);
+    bcd_t v(value);
+    CHECK(v.is_valid());
+    CHECK((uint8_t) v == value);
+  }
+
+  // Validity of all byte values; both nibbles must be digits
+  for (uint16_t value = 0; value < 256; value++) {
+    uint8_t byte = value;
+    bcd_t v;
+    raw(&v, &byte, 1);
+    CHECK(v.is_valid() == valid(byte));
+  }
+
+  // Block decode; one invalid value at each position, all values
+  // invalid, and random blocks of 1..8 values
+  for (uint8_t count = 1; count <= 8; count++) {
+    for (uint8_t pos = 0; pos < count; pos++) {
+      for (uint16_t bad = 0; bad < 256; bad++) {
+	if (valid(bad)) continue;
+	uint8_t src[8];
+	for (uint8_t i = 0; i < count; i++) src[i] = 0x59;
+	src[pos] = bad;
+	bcd_t block[8];
+	uint8_t dest[8];
+	raw(block, src, count);
+	CHECK(bcd_t::decode(dest, block, count) == (1 << pos));
+	for (uint8_t i = 0; i < count; i++)
+	  if (i != pos) CHECK(dest[i] == 59);
+      }
+    }
+  }
+  for (uint32_t n = 0; n < 100000; n++) {
+    uint8_t count = (next() & 7) + 1;
+    uint64_t r = next();
+    uint8_t src[8];
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      src[i] = r >> (i * 8);
+      if (!valid(src[i])) mask |= (1 << i);
+    }
+    bcd_t block[8];
+    uint8_t dest[8];
+    raw(block, src, count);
+    CHECK(bcd_t::decode(dest, block, count) == mask);
+    for (uint8_t i = 0; i < count; i++)
+      if (valid(src[i]))
+	CHECK(dest[i] == (src[i] >> 4) * 10 + (src[i] & 0x0f));
+  }
+
+  // Block encode and decode of 0..99
+  uint8_t src[100];
+  bcd_t block[100];
+  uint8_t dest[100];
+  for (uint8_t i = 0; i < 100; i++) src[i] = i;
+  bcd_t::encode(block, src, 100);
+  for (uint8_t i = 0; i < 100; i += 8) {
+    uint8_t count = (100 - i) < 8 ? (100 - i) : 8;
+    CHECK(bcd_t::decode(&dest[i], &block[i], count) == 0);
+  }
+  CHECK(memcmp(src, dest, sizeof(dest)) == 0);
+
+  return (report("bcd"));
+}
@@ -0,0 +1,152 @@
+/**
+ * @file test_calendar.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+
+/**
+ * Test of the software real-time clock with calendar. The clock is
+ * ticked each second over whole years, and over each midnight in
+ * the time_t range (32-bit) or years 1600 to 2800 (TIME_64). The
+ * clock is updated with random number of seconds over 136 years, and
+ * the calendar set with random steps less than a day over the range.
+ * The calendar is compared with gmtime_r() after each step.
+ */
+
+#if TIME_64
+// Days in the 400 year cycle
+static const int32_t CYCLE = 146097L;
+static const time_t BEGIN = -(time_t) CYCLE * ONE_DAY;
+static const time_t END = 2 * (time_t) CYCLE * ONE_DAY;
+#else
+static const time_t BEGIN = 0;
+static const time_t END = UINT32_MAX - ONE_DAY;
+#endif
+
+// Range of random updates; 32-bit time_t range from the beginning
+static const time_t UPDATE_END = BEGIN + (UINT32_MAX - ONE_DAY);
+
+static uint32_t errors = 0;
+
+/**
+ * Compare the given broken-down time with gmtime_r().
+ * @param[in] time stamp.
+ * @param[in] now broken-down time.
+ */
+static void check(time_t time, const struct tm& now)
+{
+  struct tm expected;
+  gmtime_r(&time, &expected);
+  if (memcmp(&now, &expected, sizeof(now)) && errors++ < 8)
+    printf("calendar(%lld): %d-%d-%d %d:%d:%d yday %d wday %d\n",
+	   (long long) time, now.tm_year, now.tm_mon, now.tm_mday,
+	   now.tm_hour, now.tm_min, now.tm_sec, now.tm_yday, now.tm_wday);
+}
+
+/**
+ * Compare the calendar of the given clock with gmtime_r().
+ * @param[in] rtc clock.
+ */
+static void check(CalendarRTC& rtc)
+{
+  struct tm now;
+  rtc.get_time(now);
+  check(rtc.get_time(), now);
+}
+
+/**
+ * Tick the given clock from the given time for the given number of
+ * seconds, and check the calendar each second.
+ * @param[in] rtc clock.
+ * @param[in] time to start from.
+ * @param[in] seconds to tick.
+ * @return number of ticks.
+ */
+static uint32_t tick(CalendarRTC& rtc, time_t time, uint32_t seconds)
+{
+  rtc.set_time(time);
+  check(rtc);
+  for (uint32_t i = 0; i < seconds; i++) {
+    host_millis += 1000;
+    if (!rtc.tick() && errors++ < 8) printf("tick: no increment\n");
+    check(rtc);
+  }
+  return (seconds);
+}
+
+/**
+ * Return next pseudo-random number (xorshift32).
+ * @return random number.
+ */
+static uint32_t next()
+{
+  static uint32_t x = 2463534242UL;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return (x);
+}
+
+int main()
+{
+  CalendarRTC rtc;
+  uint32_t ticks = 0;
+
+  // Tick each second over leap years and century years
+  static const uint16_t YEAR[] = {
+#if TIME_64
+    1600, 1700, 1900,
+#endif
+    2000, 2004, 2099, 2100
+  };
+  for (uint8_t i = 0; i < sizeof(YEAR) / sizeof(YEAR[0]); i++) {
+    struct tm now(0, YEAR[i], JANUARY, 1, 0, 0, 0);
+    ticks += tick(rtc, mk_gmtime(&now), 366 * ONE_DAY);
+  }
+
+  // Tick over each midnight
+  for (time_t time = BEGIN + ONE_DAY - 60; time < END; time += ONE_DAY)
+    ticks += tick(rtc, time, 120);
+
+  // Update with random number of seconds (less than a minute)
+  uint32_t updates = 0;
+  rtc.set_time(BEGIN);
+  while (rtc.get_time() < UPDATE_END) {
+    uint16_t seconds = next() % 60;
+    host_millis += seconds * 1000UL;
+    if (rtc.update() != seconds && errors++ < 8)
+      printf("update: %u seconds\n", seconds);
+    check(rtc);
+    updates++;
+  }
+
+  // Set calendar with random steps less than a day
+  Calendar calendar;
+  uint32_t steps = 0;
+  calendar.set(BEGIN);
+  for (time_t time = BEGIN; time < END; time += next() % ONE_DAY) {
+    struct tm now;
+    calendar.gmtime_r(&time, &now);
+    check(time, now);
+    steps++;
+  }
+
+  printf("calendar: %lu ticks, %lu updates, %lu steps, %lu errors\n",
+	 (unsigned long) ticks, (unsigned long) updates,
+	 (unsigned long) steps, (unsigned long) errors);
+  return (errors != 0);
+}
@@ -0,0 +1,550 @@
+/**
+ * @file test_ds1302.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "GPIO.h"
+#include "RTC.h"
+#include "test.h"
+#include "Driver/DS1302.h"
+#include "RAMCache.h"
+#include "Record.h"
+
+/**
+ * Test of the DS1302 driver on a simulated device. With the GPIO
+ * transport the device is clocked bit by bit from the mock pins, and
+ * the chip select to clock setup time, and the clock high and low
+ * times are measured in cycles. With a mock transport the bytes are
+ * passed directly to the device; the protocol, number of transfers,
+ * register range checks, and the cache and record store on the
+ * static memory.
+ */
+
+/**
+ * Simulated DS1302 device; command byte followed by data bytes
+ * within a chip select block. Clock registers and static memory,
+ * single and burst transfer, and write protect.
+ */
+class Model {
+public:
+  Model() :
+    transactions(0),
+    protocol(0),
+    m_command(false),
+    m_cmd(0),
+    m_index(0)
+  {
+    memset(reg, 0, sizeof(reg));
+    memset(ram, 0, sizeof(ram));
+    reg[WP] = 0x80;
+  }
+
+  /** Chip select asserted; next byte is the command. */
+  void select()
+  {
+    transactions += 1;
+    m_command = true;
+  }
+
+  /**
+   * Return true(1) if the command is a read, otherwise false(0).
+   * @return bool.
+   */
+  bool is_read() const
+  {
+    return (!m_command && (m_cmd & 0x01));
+  }
+
+  /**
+   * Byte written by the host; command or data.
+   * @param[in] data byte.
+   */
+  void write(uint8_t data)
+  {
+    if (m_command) {
+      if ((data & 0x80) == 0) protocol++;
+      m_cmd = data;
+      m_index = 0;
+      m_command = false;
+      return;
+    }
+    if (m_cmd & 0x01) {
+      protocol++;
+      return;
+    }
+    uint8_t* dp = address();
+    if (dp == NULL) return;
+    if ((reg[WP] & 0x80) == 0 || dp == &reg[WP]) *dp = data;
+  }
+
+  /**
+   * Return byte read by the host.
+   * @return byte.
+   */
+  uint8_t read()
+  {
+    if (!is_read()) {
+      protocol++;
+      return (0xff);
+    }
+    uint8_t* dp = address();
+    return (dp == NULL ? 0 : *dp);
+  }
+
+  /** Write protect register. */
+  static const uint8_t WP = 7;
+
+  /** Clock registers and write protect. */
+  uint8_t reg[8];
+
+  /** Static memory. */
+  uint8_t ram[31];
+
+  /** Number of chip select blocks. */
+  uint32_t transactions;
+
+  /** Number of protocol errors. */
+  uint32_t protocol;
+
+protected:
+  bool m_command;
+  uint8_t m_cmd;
+  uint8_t m_index;
+
+  /**
+   * Return pointer to the register or memory of the next byte in the
+   * transfer, or NULL if outside.
+   * @return pointer.
+   */
+  uint8_t* address()
+  {
+    bool memory = (m_cmd & 0x40);
+    uint8_t addr = (m_cmd >> 1) & 0x1f;
+    if (addr == 0x1f)
+      addr = m_index++;
+    else if (m_index++ != 0)
+      return (NULL);
+    if (memory) return (addr < sizeof(ram) ? &ram[addr] : NULL);
+    return (addr < sizeof(reg) ? &reg[addr] : NULL);
+  }
+};
+
+/**
+ * Three-wire interface of the simulated device on the mock pins;
+ * bits are latched on the rising clock edge and shifted out on the
+ * falling clock edge, least significant bit first. The shortest
+ * chip select to clock setup, clock high and clock low times are
+ * recorded.
+ */
+class Wire : public host_gpio_device_t {
+public:
+  Wire(Model& model) :
+    t_cc(UINT32_MAX),
+    t_ch(UINT32_MAX),
+    t_cl(UINT32_MAX),
+    m_model(model),
+    m_ce(false),
+    m_clk(false),
+    m_output(true),
+    m_value(false),
+    m_first(false),
+    m_reading(false),
+    m_bit(0),
+    m_data(0),
+    m_edge(0)
+  {
+    host_gpio_device() = this;
+  }
+
+  virtual void mode(BOARD::pin_t pin, bool output)
+  {
+    if (pin == IO) m_output = output;
+  }
+
+  virtual void write(BOARD::pin_t pin, bool value)
+  {
+    uint32_t cycles = host_cycles - m_edge;
+    if (pin == IO) {
+      m_value = value;
+    }
+    else if (pin == CE && value != m_ce) {
+      m_ce = value;
+      if (!value) return;
+      if (m_clk) m_model.protocol++;
+      m_model.select();
+      m_first = true;
+      m_reading = false;
+      m_bit = 0;
+      m_data = 0;
+      m_edge = host_cycles;
+    }
+    else if (pin == SCLK && value != m_clk) {
+      m_clk = value;
+      if (!m_ce) return;
+      m_edge = host_cycles;
+      if (value)
+	rising(cycles);
+      else
+	falling(cycles);
+    }
+  }
+
+  virtual bool read(BOARD::pin_t pin)
+  {
+    if (pin != IO || m_output || !m_reading) m_model.protocol++;
+    return ((m_data >> m_bit) & 1);
+  }
+
+  /** Shortest chip select to clock setup time (cycles). */
+  uint32_t t_cc;
+
+  /** Shortest clock high time (cycles). */
+  uint32_t t_ch;
+
+  /** Shortest clock low time (cycles). */
+  uint32_t t_cl;
+
+protected:
+  static const BOARD::pin_t CE = BOARD::D11;
+  static const BOARD::pin_t IO = BOARD::D12;
+  static const BOARD::pin_t SCLK = BOARD::D13;
+
+  Model& m_model;
+  bool m_ce;
+  bool m_clk;
+  bool m_output;
+  bool m_value;
+  bool m_first;
+  bool m_reading;
+  uint8_t m_bit;
+  uint8_t m_data;
+  uint64_t m_edge;
+
+  /** Latch bit written by the host; command or data. */
+  void rising(uint32_t cycles)
+  {
+    if (m_first) {
+      if (cycles < t_cc) t_cc = cycles;
+      m_first = false;
+    }
+    else if (cycles < t_cl) {
+      t_cl = cycles;
+    }
+    if (m_reading) return;
+    if (!m_output) m_model.protocol++;
+    m_data |= (m_value << m_bit);
+    if (++m_bit < 8) return;
+    m_model.write(m_data);
+    m_bit = 0;
+    m_data = 0;
+    if (m_model.is_read()) {
+      m_reading = true;
+      m_bit = 7;
+    }
+  }
+
+  /** Shift out next bit read by the host. */
+  void falling(uint32_t cycles)
+  {
+    if (cycles < t_ch) t_ch = cycles;
+    if (!m_reading) return;
+    if (++m_bit < 8) return;
+    m_data = m_model.read();
+    m_bit = 0;
+  }
+};
+
+/**
+ * Mock transport for the DS1302 driver; bytes are passed directly to
+ * the simulated device. The chip select block and data direction are
+ * checked.
+ */
+class Transport {
+public:
+  /** Simulated device. */
+  static Model* model;
+
+  Transport() :
+    m_selected(false),
+    m_input(false)
+  {}
+
+  void select()
+  {
+    if (m_selected) model->protocol++;
+    m_selected = true;
+    model->select();
+  }
+
+  void deselect()
+  {
+    if (!m_selected || m_input) model->protocol++;
+    m_selected = false;
+  }
+
+  void input()
+  {
+    m_input = true;
+  }
+
+  void output()
+  {
+    m_input = false;
+  }
+
+  uint8_t read()
+  {
+    if (!m_selected || !m_input) model->protocol++;
+    return (model->read());
+  }
+
+  void write(uint8_t data)
+  {
+    if (!m_selected || m_input) model->protocol++;
+    model->write(data);
+  }
+
+protected:
+  bool m_selected;
+  bool m_input;
+};
+
+Model* Transport::model = NULL;
+
+typedef DS1302Driver<Transport> Device;
+
+/**
+ * Run the driver on the simulated device with the mock transport;
+ * number of transfers per operation, register range checks, and
+ * cache and record store on the static memory.
+ */
+static void check_protocol()
+{
+  Model model;
+  Transport::model = &model;
+  Device rtc;
+  struct tm now(SATURDAY, 2023, DECEMBER, 31, 23, 59, 30);
+  struct tm res;
+  uint8_t buf[Device::RAM_MAX];
+  uint32_t transactions;
+
+  // Clock; burst write with write enable, and burst read
+  transactions = model.transactions;
+  CHECK(rtc.set_time(now));
+  CHECK(model.transactions == transactions + 2);
+  CHECK(model.reg[Model::WP] == 0x80);
+  CHECK(rtc.get_time(res));
+  CHECK(model.transactions == transactions + 3);
+  CHECK(res.tm_year == now.tm_year && res.tm_mon == now.tm_mon);
+  CHECK(res.tm_mday == now.tm_mday && res.tm_wday == now.tm_wday);
+  CHECK(res.tm_hour == 23 && res.tm_min == 59 && res.tm_sec == 30);
+
+  // Registers with invalid values
+  static const struct {
+    uint8_t reg;
+    uint8_t value;
+  } INVALID[] = {
+    { 0, 0x80 }, { 0, 0x60 }, { 0, 0x0a }, { 1, 0x60 }, { 2, 0x24 },
+    { 3, 0x00 }, { 3, 0x32 }, { 4, 0x00 }, { 4, 0x13 }, { 5, 0x00 },
+    { 5, 0x08 }, { 6, 0xa0 }
+  };
+  for (size_t i = 0; i < sizeof(INVALID) / sizeof(INVALID[0]); i++) {
+    uint8_t value = model.reg[INVALID[i].reg];
+    model.reg[INVALID[i].reg] = INVALID[i].value;
+    CHECK(!rtc.get_time(res));
+    model.reg[INVALID[i].reg] = value;
+  }
+  CHECK(rtc.get_time(res));
+
+  // Static memory; burst from address zero, single byte otherwise
+  for (size_t i = 0; i < sizeof(buf); i++) buf[i] = next();
+  transactions = model.transactions;
+  CHECK(rtc.write_ram(0, buf, sizeof(buf)));
+  CHECK(model.transactions == transactions + 3);
+  CHECK(!memcmp(model.ram, buf, sizeof(buf)));
+  transactions = model.transactions;
+  CHECK(rtc.write_ram(10, buf, 4));
+  CHECK(model.transactions == transactions + 4 + 2);
+  CHECK(!memcmp(model.ram + 10, buf, 4));
+  transactions = model.transactions;
+  CHECK(rtc.read_ram(10, buf + 10, 4));
+  CHECK(model.transactions == transactions + 4);
+  transactions = model.transactions;
+  CHECK(rtc.read_ram(0, buf, sizeof(buf)));
+  CHECK(model.transactions == transactions + 1);
+  CHECK(!memcmp(model.ram, buf, sizeof(buf)));
+  CHECK(model.reg[Model::WP] == 0x80);
+
+  // Block outside static memory; address 31 is the burst command
+  transactions = model.transactions;
+  CHECK(!rtc.write_ram(28, buf, 4));
+  CHECK(!rtc.read_ram(28, buf, 4));
+  CHECK(!rtc.read_ram(0, buf, Device::RAM_MAX + 1));
+  CHECK(model.transactions == transactions);
+  CHECK(!memcmp(model.ram, buf, sizeof(buf)));
+  CHECK(rtc.read_ram(27, buf + 27, 4));
+
+  // Write protected
+  rtc.write_ram(3, buf[3] ^ 0xff);
+  CHECK(model.ram[3] == buf[3]);
+  rtc.write_enable();
+  rtc.write_ram(3, buf[3] ^ 0xff);
+  rtc.write_disable();
+  CHECK(model.ram[3] == (buf[3] ^ 0xff) && rtc.read_ram(3) == model.ram[3]);
+
+  // Cache; flush with the fewest transfer bytes, burst from address
+  // zero or single byte writes
+  RAMCache<Device> cache(rtc);
+  uint8_t ram[Device::RAM_MAX];
+  CHECK(cache.begin());
+  memcpy(ram, model.ram, sizeof(ram));
+  for (uint16_t i = 0; i < 10000; i++) {
+    uint8_t first = Device::RAM_MAX;
+    uint8_t last = 0;
+    for (uint8_t n = next() % 4; n != 0; n--) {
+      uint8_t addr = next() % (next() % 2 ? 8 : Device::RAM_MAX);
+      uint8_t data = next();
+      cache.write_ram(addr, data);
+      if (ram[addr] != data) {
+	if (addr < first) first = addr;
+	if (addr > last) last = addr;
+      }
+      ram[addr] = data;
+    }
+    transactions = model.transactions;
+    CHECK(cache.flush());
+    CHECK(!memcmp(model.ram, ram, sizeof(ram)));
+    if (first == Device::RAM_MAX) {
+      CHECK(model.transactions == transactions);
+      continue;
+    }
+    uint8_t count = last - first + 1;
+    bool burst = (first == 0 || last + 2 <= 2 * count);
+    CHECK(model.transactions == transactions + (burst ? 1 : count) + 2);
+  }
+  CHECK(model.reg[Model::WP] == 0x80 && model.protocol == 0);
+
+  // Record store; cleared memory is not valid
+  struct state_t {
+    uint16_t boots;
+    uint32_t uptime;
+  };
+  memset(model.ram, 0, sizeof(model.ram));
+  Record<Device, state_t> state(rtc, Device::RAM_START);
+  CHECK(!state.begin());
+  for (uint16_t i = 0; i < 300; i++) {
+    state.data().boots += 1;
+    state.data().uptime = next();
+    state_t latest = state.data();
+    CHECK(state.commit());
+    Record<Device, state_t> restored(rtc, Device::RAM_START);
+    CHECK(restored.begin());
+    CHECK(!memcmp(&restored.data(), &latest, sizeof(latest)));
+  }
+  CHECK(model.reg[Model::WP] == 0x80 && model.protocol == 0);
+}
+
+/**
+ * Return number of cycles for the given time at F_CPU, rounded up.
+ * @param[in] ns time in nano-seconds.
+ * @return cycles.
+ */
+static uint32_t cycles(uint32_t ns)
+{
+  return (((uint64_t) ns * F_CPU + 999999999ULL) / 1000000000ULL);
+}
+
+/**
+ * Run the driver on the simulated device; clock, single and burst
+ * memory transfer, and check the bus timing against the given
+ * minimum times.
+ * @param[in] rtc device driver.
+ * @param[in] model simulated device.
+ * @param[in] wire simulated device interface.
+ * @param[in] t_ch minimum clock high time (ns).
+ * @param[in] t_cl minimum clock low time (ns).
+ * @param[in] t_cc minimum chip select to clock setup time (ns).
+ */
+template<typename DEVICE>
+static void check(DEVICE& rtc, Model& model, Wire& wire,
+		  uint16_t t_ch, uint16_t t_cl, uint16_t t_cc)
+{
+  struct tm now(SATURDAY, 2023, DECEMBER, 31, 23, 59, 30);
+  struct tm res;
+
+  // Clock; set and read back
+  CHECK(rtc.set_time(now));
+  CHECK(model.reg[0] == 0x30 && model.reg[1] == 0x59 && model.reg[2] == 0x23);
+  CHECK(model.reg[3] == 0x31 && model.reg[4] == 0x12 && model.reg[5] == 0x07);
+  CHECK(model.reg[6] == 0x23 && model.reg[Model::WP] == 0x80);
+  CHECK(rtc.get_time(res));
+  CHECK(res.tm_year == now.tm_year && res.tm_mon == now.tm_mon);
+  CHECK(res.tm_mday == now.tm_mday && res.tm_wday == now.tm_wday);
+  CHECK(res.tm_hour == 23 && res.tm_min == 59 && res.tm_sec == 30);
+
+  // Clock halted
+  model.reg[0] |= 0x80;
+  CHECK(!rtc.get_time(res));
+  model.reg[0] &= 0x7f;
+
+  // Static memory; burst and single byte transfer
+  uint8_t buf[DEVICE::RAM_MAX];
+  uint8_t data[DEVICE::RAM_MAX];
+  for (size_t i = 0; i < sizeof(buf); i++) buf[i] = i * 7 + 3;
+  CHECK(rtc.write_ram(0, buf, sizeof(buf)));
+  CHECK(!memcmp(model.ram, buf, sizeof(buf)));
+  CHECK(rtc.read_ram(0, data, sizeof(data)));
+  CHECK(!memcmp(data, buf, sizeof(buf)));
+  CHECK(rtc.write_ram(5, "\xaa\x55", 2));
+  CHECK(model.ram[5] == 0xaa && model.ram[6] == 0x55);
+  CHECK(rtc.read_ram(4, data, 4));
+  CHECK(data[0] == buf[4] && data[1] == 0xaa && data[2] == 0x55);
+  CHECK(data[3] == buf[7] && model.reg[Model::WP] == 0x80);
+
+  // Bus timing
+  CHECK(model.protocol == 0);
+  CHECK(wire.t_cc >= cycles(t_cc));
+  CHECK(wire.t_ch >= cycles(t_ch));
+  CHECK(wire.t_cl >= cycles(t_cl));
+  printf("ds1302: t_cc %lu, t_ch %lu, t_cl %lu cycles\n",
+	 (unsigned long) wire.t_cc, (unsigned long) wire.t_ch,
+	 (unsigned long) wire.t_cl);
+}
+
+int main()
+{
+  // Default timing; 5 V
+  {
+    Model model;
+    Wire wire(model);
+    DS1302<BOARD::D11, BOARD::D12, BOARD::D13> rtc;
+    check(rtc, model, wire, 250, 250, 1000);
+  }
+
+  // Timing at 2 V
+  {
+    Model model;
+    Wire wire(model);
+    DS1302<BOARD::D11, BOARD::D12, BOARD::D13, 1000, 1000, 4000> rtc;
+    check(rtc, model, wire, 1000, 1000, 4000);
+  }
+
+  // Protocol with mock transport
+  host_gpio_device() = NULL;
+  check_protocol();
+
+  return (report("ds1302"));
+}
@@ -0,0 +1,196 @@
+/**
+ * @file test_ds1307.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+#include "test.h"
+#include "TWI.h"
+#include "Hardware/TWI.h"
+#include "Driver/DS1307.h"
+
+/**
+ * Test of the DS1307 driver on the mock TWI bus; blocking and
+ * asynchronous read of the clock, bus bit rate during asynchronous
+ * read, address NACK, busy bus, and register range checks.
+ */
+
+// Clock registers; 2025-12-31 12:34:56, Wednesday
+static const uint8_t CLOCK[] = { 0x56, 0x34, 0x12, 0x04, 0x31, 0x12, 0x25 };
+
+// Completion callback; number of calls and latest status
+static uint8_t callbacks = 0;
+static bool callback_status = false;
+
+static void completed(DS1307* rtc, bool status)
+{
+  (void) rtc;
+  callbacks += 1;
+  callback_status = status;
+}
+
+/**
+ * Slave that records the bus bit rate at each address condition;
+ * forwards to the mock bus.
+ */
+struct Probe : host_twi_slave_t {
+  Probe(::TWI& twi) : m_twi(twi), twbr(0), twsr(0) {}
+  virtual bool address(uint8_t sla)
+  {
+    twbr = TWBR;
+    twsr = TWSR & 0x03;
+    return (m_twi.address(sla));
+  }
+  virtual bool write(uint8_t data) { return (m_twi.write(data)); }
+  virtual uint8_t read() { return (m_twi.read()); }
+  virtual void stop() { m_twi.stop(); }
+  ::TWI& m_twi;
+  uint8_t twbr;
+  uint8_t twsr;
+};
+
+/**
+ * Run asynchronous read to completion. Return number of polls while
+ * in progress, and the final poll status.
+ * @param[in] rtc device driver.
+ * @param[out] res final poll status.
+ * @return number of polls.
+ */
+static uint16_t run(DS1307& rtc, int8_t& res)
+{
+  uint16_t polls = 0;
+  while ((res = rtc.poll()) == 0 && polls < 1000) polls++;
+  return (polls);
+}
+
+int main()
+{
+  struct tm now;
+  int8_t res;
+
+  // Blocking read and write on the generic bus manager
+  ::TWI bus;
+  DS1307 generic(bus);
+  memcpy(bus.mem, CLOCK, sizeof(CLOCK));
+  CHECK(generic.get_time(now));
+  CHECK(now.tm_year == 125 && now.tm_mon == DECEMBER && now.tm_mday == 31);
+  CHECK(now.tm_hour == 12 && now.tm_min == 34 && now.tm_sec == 56);
+  CHECK(now.tm_wday == WEDNESDAY);
+  CHECK(bus.transactions == 2 && !bus.is_locked());
+  now.tm_sec = 7;
+  CHECK(generic.set_time(now));
+  CHECK(bus.mem[0] == 0x07 && !memcmp(bus.mem + 1, CLOCK + 1, 6));
+
+  // Bus failure; the bus is released
+  bus.fail = true;
+  CHECK(!generic.get_time(now) && !bus.is_locked());
+  CHECK(!generic.set_time(now) && !bus.is_locked());
+  bus.fail = false;
+  CHECK(generic.get_time(now));
+
+  // Asynchronous read is not available on the generic bus manager
+  CHECK(!generic.get_time_async());
+  CHECK(generic.poll() == -1 && !bus.is_locked());
+
+  // Asynchronous read on the hardware bus manager
+  Hardware::TWI twi(100000UL);
+  DS1307 rtc(twi);
+  memcpy(twi.mem, CLOCK, sizeof(CLOCK));
+  CHECK(rtc.poll() == -1 && !rtc.get_time_result(now));
+  CHECK(rtc.get_time_async(completed));
+  CHECK(!rtc.get_time_async(completed));
+  CHECK(twi.is_locked());
+  CHECK(run(rtc, res) > sizeof(CLOCK) && res == 1);
+  CHECK(callbacks == 1 && callback_status && !twi.is_locked());
+  CHECK(rtc.poll() == 1);
+  CHECK(rtc.get_time_result(now));
+  CHECK(now.tm_year == 125 && now.tm_mon == DECEMBER && now.tm_mday == 31);
+  CHECK(now.tm_hour == 12 && now.tm_min == 34 && now.tm_sec == 56);
+  CHECK(now.tm_wday == WEDNESDAY);
+
+  // Same result as the blocking read; both on the hardware bus
+  struct tm blocking;
+  CHECK(rtc.get_time(blocking) && !memcmp(&now, &blocking, sizeof(now)));
+
+  // Bit rate is kept when slower than the device max, and limited to
+  // 100 kHz during the transfer when faster; restored afterwards
+  static const struct {
+    uint8_t twbr;		// Bit rate register
+    uint8_t twsr;		// Prescaler
+    uint8_t expect;		// Bit rate register during transfer
+  } RATE[] = {
+    { 72, 0, 72 },		// 100 kHz
+    { 152, 0, 152 },		// 50 kHz
+    { 12, 0, 72 },		// 400 kHz
+    { 32, 0, 72 },		// 200 kHz
+    { 18, 1, 18 },		// 100 kHz, prescaler 4
+    { 5, 2, 5 },		// 91 kHz, prescaler 16
+    { 2, 2, 72 },		// 200 kHz, prescaler 16
+    { 0, 3, 72 }		// 1 MHz, prescaler 64
+  };
+  Probe probe(twi);
+  host_twi_slave = &probe;
+  for (size_t i = 0; i < sizeof(RATE) / sizeof(RATE[0]); i++) {
+    TWBR = RATE[i].twbr;
+    TWSR = RATE[i].twsr;
+    CHECK(rtc.get_time_async());
+    run(rtc, res);
+    CHECK(res == 1 && rtc.get_time_result(now));
+    CHECK(probe.twbr == RATE[i].expect);
+    CHECK(probe.twsr == (RATE[i].expect == RATE[i].twbr ? RATE[i].twsr : 0));
+    CHECK(TWBR == RATE[i].twbr && (TWSR & 0x03) == RATE[i].twsr);
+  }
+  host_twi_slave = &twi;
+
+  // Address NACK
+  twi.fail = true;
+  CHECK(rtc.get_time_async(completed));
+  run(rtc, res);
+  CHECK(res == -1 && callbacks == 2 && !callback_status);
+  CHECK(!twi.is_locked() && !rtc.get_time_result(now));
+  twi.fail = false;
+
+  // Busy bus
+  CHECK(twi.acquire());
+  CHECK(!rtc.get_time_async());
+  CHECK(twi.release());
+  CHECK(rtc.get_time_async());
+  run(rtc, res);
+  CHECK(res == 1 && rtc.get_time_result(now));
+
+  // Clock halted and register values out of range
+  static const uint8_t INVALID[][7] = {
+    { 0x80, 0x34, 0x12, 0x04, 0x31, 0x12, 0x25 },
+    { 0x56, 0x60, 0x12, 0x04, 0x31, 0x12, 0x25 },
+    { 0x56, 0x34, 0x24, 0x04, 0x31, 0x12, 0x25 },
+    { 0x56, 0x34, 0x12, 0x00, 0x31, 0x12, 0x25 },
+    { 0x56, 0x34, 0x12, 0x08, 0x31, 0x12, 0x25 },
+    { 0x56, 0x34, 0x12, 0x04, 0x00, 0x12, 0x25 },
+    { 0x56, 0x34, 0x12, 0x04, 0x32, 0x12, 0x25 },
+    { 0x56, 0x34, 0x12, 0x04, 0x31, 0x00, 0x25 },
+    { 0x56, 0x34, 0x12, 0x04, 0x31, 0x13, 0x25 },
+    { 0x56, 0x34, 0x12, 0x04, 0x31, 0x12, 0xa0 }
+  };
+  for (size_t i = 0; i < sizeof(INVALID) / sizeof(INVALID[0]); i++) {
+    memcpy(twi.mem, INVALID[i], sizeof(INVALID[i]));
+    CHECK(!rtc.get_time(now));
+    CHECK(rtc.get_time_async());
+    run(rtc, res);
+    CHECK(res == 1 && !rtc.get_time_result(now));
+  }
+
+  return (report("ds1307"));
+}
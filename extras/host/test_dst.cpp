@@ -0,0 +1,228 @@
+/**
+ * @file test_dst.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+#include "ref.h"
+#include "Hardware/AVR/eu_dst.h"
+#include "Hardware/AVR/usa_dst.h"
+#include <signal.h>
+#include <ucontext.h>
+
+/**
+ * Test of the Daylight Saving caches of eu_dst() and usa_dst() when
+ * called from both the main program and an interrupt service
+ * routine. The main program call is single-stepped (x86-64 trap
+ * flag), and an interrupt that calls the same function with a time
+ * stamp in another interval, and another time zone, is raised after
+ * the n:th instruction, for each n until the function returns. Both
+ * results, and the cache after the calls, are checked against the C
+ * library time zones. The functions are also checked against the C
+ * library over the years of the current rules.
+ */
+
+// Instruction count and instruction to raise the interrupt after
+static volatile uint32_t step;
+static volatile uint32_t inject;
+
+// Daylight Saving function, and interrupt time stamp, zone and result
+static int (*dst)(const time_t*, int32_t*);
+static time_t isr_time;
+static int32_t isr_zone;
+static volatile int isr_res;
+
+/**
+ * Interrupt service routine; Daylight Saving of another time stamp.
+ */
+static void isr()
+{
+  isr_res = dst(&isr_time, &isr_zone);
+}
+
+/**
+ * Trap signal handler; raise interrupt after the given instruction.
+ */
+static void trap(int, siginfo_t*, void*)
+{
+  if (step++ == inject) host_interrupt(isr);
+}
+
+/** Start single-stepping; set trap flag. */
+#define TRACE_ON()							\
+  __asm__ __volatile__("pushfq\n\torq $0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc")
+
+/** Stop single-stepping; clear trap flag. */
+#define TRACE_OFF()							\
+  __asm__ __volatile__("pushfq\n\tandq $~0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc")
+
+static uint32_t errors = 0;
+
+/**
+ * Return Daylight Saving in the European Union from the C library,
+ * Europe/Berlin. The transitions are at 01:00 UTC in all zones.
+ * @param[in] time seconds from epoch.
+ * @param[in] zone offset (not used).
+ * @return seconds.
+ */
+static int eu_rule(time_t time, int32_t zone)
+{
+  ref_tm_t tm;
+  (void) zone;
+  ref_tz("Europe/Berlin");
+  return (ref_localtime(time, &tm));
+}
+
+/**
+ * Return Daylight Saving in the USA from the C library; the zone with
+ * the given offset, America/New_York (EST) to America/Los_Angeles
+ * (PST).
+ * @param[in] time seconds from epoch.
+ * @param[in] zone offset.
+ * @return seconds.
+ */
+static int usa_rule(time_t time, int32_t zone)
+{
+  static const char* const ZONE[] = {
+    "America/New_York", "America/Chicago", "America/Denver",
+    "America/Los_Angeles"
+  };
+  ref_tm_t tm;
+  ref_tz(ZONE[-zone / ONE_HOUR - 5]);
+  return (ref_localtime(time, &tm));
+}
+
+/**
+ * Check the Daylight Saving function against the C library for
+ * every hour of the given years, and every second of the hours with
+ * a transition. Return number of checks.
+ * @param[in] fn name of function.
+ * @param[in] rule Daylight Saving from the C library.
+ * @param[in] zone zone offset.
+ * @param[in] first year.
+ * @param[in] last year.
+ * @return number of checks.
+ */
+static uint32_t sweep(const char* fn, int (*rule)(time_t, int32_t),
+		      int32_t zone, int16_t first, int16_t last)
+{
+  struct tm start(SATURDAY, first, JANUARY, 1, 0, 0, 0);
+  struct tm end(SATURDAY, last + 1, JANUARY, 1, 0, 0, 0);
+  time_t stop = mk_gmtime(&end);
+  uint32_t checks = 0;
+  int prev = rule(mk_gmtime(&start), zone);
+  for (time_t t = mk_gmtime(&start); t < stop; t += ONE_HOUR) {
+    int res = rule(t, zone);
+    time_t s = t;
+    if (res != prev) s = t - ONE_HOUR + 1;
+    for (; s <= t; s++, checks++) {
+      int32_t z = zone;
+      if (dst(&s, &z) != rule(s, zone) && errors++ < 8)
+	printf("%s: %lu\n", fn, (unsigned long) s);
+    }
+    prev = res;
+  }
+  return (checks);
+}
+
+/**
+ * Call the Daylight Saving function from the main program with the
+ * given time stamp and zone, and from the interrupt after each
+ * instruction with another. The cache is primed with a third time
+ * stamp. Return number of interrupt points.
+ * @param[in] fn name of function.
+ * @param[in] rule Daylight Saving from the C library.
+ * @param[in] prime time stamp to prime the cache.
+ * @param[in] time time stamp of main program.
+ * @param[in] zone zone offset of main program.
+ * @return number of interrupt points.
+ */
+static uint32_t check(const char* fn, int (*rule)(time_t, int32_t),
+		      time_t prime, time_t time, int32_t zone)
+{
+  for (inject = 0;; inject++) {
+    int32_t z = zone;
+    dst(&prime, &z);
+    step = 0;
+    isr_res = -1;
+    TRACE_ON();
+    int res = dst(&time, &z);
+    TRACE_OFF();
+    if (inject >= step) break;
+
+    // Results, and the cache after both calls
+    static const int32_t PROBE[] = {
+      -(int32_t) ONE_DAY, -ONE_HOUR - 1, -ONE_HOUR, -1, 0, 1, ONE_HOUR,
+      ONE_DAY
+    };
+    bool ok = (res == rule(time, zone))
+      && (isr_res == rule(isr_time, isr_zone));
+    for (size_t i = 0; i < sizeof(PROBE) / sizeof(PROBE[0]); i++) {
+      time_t t = time + PROBE[i];
+      z = zone;
+      ok = ok && (dst(&t, &z) == rule(t, zone));
+      t = isr_time + PROBE[i];
+      z = isr_zone;
+      ok = ok && (dst(&t, &z) == rule(t, isr_zone));
+      t = prime + PROBE[i];
+      z = zone;
+      ok = ok && (dst(&t, &z) == rule(t, zone));
+    }
+    if (!ok && errors++ < 8)
+      printf("%s: interrupt after instruction %u\n", fn, inject);
+  }
+  return (inject);
+}
+
+int main()
+{
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_sigaction = trap;
+  sa.sa_flags = SA_SIGINFO;
+  sigaction(SIGTRAP, &sa, NULL);
+  uint32_t steps = 0;
+
+  // Summer 2017, winter 2017-2018, and summer 2016
+  struct tm prime(SATURDAY, 2017, JULY, 1, 12, 0, 0);
+  struct tm winter(SATURDAY, 2017, DECEMBER, 30, 12, 0, 0);
+  struct tm other(FRIDAY, 2016, JULY, 1, 12, 0, 0);
+
+  dst = eu_dst;
+  isr_time = mk_gmtime(&other);
+  isr_zone = ONE_HOUR;
+  steps += check("eu_dst", eu_rule, mk_gmtime(&prime), mk_gmtime(&winter),
+		 ONE_HOUR);
+
+  dst = usa_dst;
+  isr_zone = -8 * (int32_t) ONE_HOUR;
+  steps += check("usa_dst", usa_rule, mk_gmtime(&prime), mk_gmtime(&winter),
+		 -5 * (int32_t) ONE_HOUR);
+
+  // Current rules; EU from 1996, USA from 2007, to the end of time_t
+  uint32_t checks = 0;
+  dst = eu_dst;
+  checks += sweep("eu_dst", eu_rule, ONE_HOUR, 2000, 2135);
+  dst = usa_dst;
+  for (int32_t zone = -5; zone >= -8; zone--)
+    checks += sweep("usa_dst", usa_rule, zone * (int32_t) ONE_HOUR, 2007,
+		    2135);
+
+  printf("dst: %lu interrupt points, %lu checks, %lu errors\n",
+	 (unsigned long) steps, (unsigned long) checks,
+	 (unsigned long) errors);
+  return (errors != 0);
+}
@@ -0,0 +1,131 @@
+/**
+ * @file test_gmtime.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+#include "ref.h"
+#include <pthread.h>
+#include <unistd.h>
+
+/**
+ * Exhaustive test of the division-free gmtime_r() over the whole
+ * 32-bit time_t range. Each midnight is compared with the original
+ * ldiv/div based conversion and the C library. Each time stamp is
+ * compared with the date of the midnight, and the time of day by
+ * division. The range is split over the available processors.
+ */
+
+// Original conversion; GMTIME_R_FAST disabled
+namespace original {
+#undef GMTIME_R_FAST
+#define GMTIME_R_FAST 0
+#include "Hardware/AVR/gmtime_r.cpp"
+};
+
+// Max number of threads
+static const int THREADS_MAX = 64;
+
+/** Range of time stamps and result of a thread. */
+struct range_t {
+  uint64_t begin;		//!< First time stamp.
+  uint64_t end;			//!< Last time stamp + 1.
+  uint64_t errors;		//!< Number of errors.
+};
+
+/**
+ * Compare the given broken-down time with the C library reference.
+ * @param[in] tm broken-down time.
+ * @param[in] ref reference.
+ * @return true(1) if equal, otherwise false(0).
+ */
+static bool equal(const struct tm& tm, const ref_tm_t& ref)
+{
+  return (tm.tm_sec == ref.sec && tm.tm_min == ref.min
+	  && tm.tm_hour == ref.hour && tm.tm_mday == ref.mday
+	  && tm.tm_wday == ref.wday && tm.tm_mon == ref.mon
+	  && tm.tm_year == ref.year && tm.tm_yday == ref.yday
+	  && tm.tm_isdst == 0);
+}
+
+/**
+ * Check the time stamps in the given range.
+ * @param[in,out] arg range.
+ * @return NULL.
+ */
+static void* check(void* arg)
+{
+  range_t* range = (range_t*) arg;
+  struct tm expected;
+  for (uint64_t t = range->begin; t < range->end; t++) {
+    time_t time = t;
+    uint32_t fract = t % ONE_DAY;
+    struct tm now;
+    gmtime_r(&time, &now);
+
+    // Check date with original conversion and C library at midnight
+    if (fract == 0) {
+      original::gmtime_r(&time, &expected);
+      ref_tm_t ref;
+      ref_gmtime(time, &ref);
+      if (!equal(expected, ref) || mk_gmtime(&now) != time) {
+	if (range->errors++ < 8)
+	  printf("gmtime_r(%lu): differs from C library\n",
+		 (unsigned long) time);
+      }
+    }
+
+    // Check time of day
+    expected.tm_sec = fract % 60;
+    expected.tm_min = (fract / 60) % 60;
+    expected.tm_hour = fract / ONE_HOUR;
+    if (memcmp(&now, &expected, sizeof(now))) {
+      if (range->errors++ < 8)
+	printf("gmtime_r(%lu): %d-%d-%d %d:%d:%d\n",
+	       (unsigned long) time, now.tm_year, now.tm_mon, now.tm_mday,
+	       now.tm_hour, now.tm_min, now.tm_sec);
+    }
+  }
+  return (NULL);
+}
+
+int main()
+{
+  pthread_t thread[THREADS_MAX];
+  range_t range[THREADS_MAX];
+  long threads = sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads < 1) threads = 1;
+  if (threads > THREADS_MAX) threads = THREADS_MAX;
+
+  // Split range on whole days over the threads
+  const uint64_t END = 0x100000000ULL;
+  uint64_t days = (END + ONE_DAY - 1) / ONE_DAY;
+  for (long i = 0; i < threads; i++) {
+    range[i].begin = (days * i / threads) * ONE_DAY;
+    range[i].end = (days * (i + 1) / threads) * ONE_DAY;
+    if (range[i].end > END) range[i].end = END;
+    range[i].errors = 0;
+    pthread_create(&thread[i], NULL, check, &range[i]);
+  }
+  uint64_t errors = 0;
+  for (long i = 0; i < threads; i++) {
+    pthread_join(thread[i], NULL);
+    errors += range[i].errors;
+  }
+  printf("gmtime_r: %llu time stamps, %llu errors\n",
+	 (unsigned long long) END, (unsigned long long) errors);
+  return (errors != 0);
+}
@@ -0,0 +1,136 @@
+/**
+ * @file test_hybrid.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+#include "test.h"
+#include "TWI.h"
+#include "Driver/DS1307.h"
+#include "HybridRTC.h"
+
+/**
+ * Test of the hybrid real-time clock with the DS1307 driver on the
+ * mock TWI bus. The device clock and millis() run at the same rate.
+ * Checks that the device is only read when the synchronization
+ * interval has elapsed, that the clock is stepped forward when
+ * behind the device and slowed down when ahead, and never stepped
+ * backwards, and that a failed read is retried after the interval.
+ */
+
+static TWI twi;
+static DS1307 dev(twi);
+
+// Device clock; seconds from epoch at device_millis
+static time_t device_time;
+static uint32_t device_millis;
+
+// Synchronization interval (seconds)
+static const uint32_t INTERVAL = 60;
+
+/**
+ * Set the device clock registers to the given time. Not counted as
+ * bus transactions.
+ * @param[in] time seconds from epoch.
+ */
+static void device(time_t time)
+{
+  struct tm now;
+  gmtime_r(&time, &now);
+  uint32_t transactions = twi.transactions;
+  bool fail = twi.fail;
+  twi.fail = false;
+  dev.set_time(now);
+  twi.fail = fail;
+  twi.transactions = transactions;
+  device_time = time;
+  device_millis = host_millis;
+}
+
+/**
+ * Return true(1) if the given time is within one second of the
+ * device clock, otherwise false(0).
+ * @param[in] time seconds from epoch.
+ * @return bool.
+ */
+static bool near(time_t time)
+{
+  int32_t diff = time - device_time;
+  return (diff >= -1 && diff <= 1);
+}
+
+/**
+ * Run the clock and the device for the given number of seconds,
+ * with update() every 10 ms. Return number of updates that accessed
+ * the device.
+ * @param[in] rtc hybrid clock.
+ * @param[in] seconds to run.
+ * @return number of device accesses.
+ */
+static uint32_t run(HybridRTC<DS1307>& rtc, uint32_t seconds)
+{
+  uint32_t reads = 0;
+  time_t prev = rtc.get_time();
+  for (uint32_t ms = 0; ms < seconds * 1000; ms += 10) {
+    host_millis += 10;
+    if (host_millis - device_millis >= 1000)
+      device(device_time + 1);
+    uint32_t transactions = twi.transactions;
+    rtc.update();
+    if (twi.transactions != transactions) reads += 1;
+    time_t now = rtc.get_time();
+    CHECK(now >= prev);
+    prev = now;
+  }
+  return (reads);
+}
+
+int main()
+{
+  HybridRTC<DS1307> rtc(dev, INTERVAL);
+
+  // Seed from the device
+  host_millis = 0;
+  device(mk_time<2025,1,1,12,0,0>());
+  CHECK(rtc.begin());
+  CHECK(rtc.get_time() == device_time);
+
+  // One read per interval
+  uint32_t reads = run(rtc, 10 * INTERVAL);
+  CHECK(reads >= 9 && reads <= 11);
+  CHECK(near(rtc.get_time()));
+
+  // Failed reads; retried once per interval
+  twi.fail = true;
+  reads = run(rtc, 10 * INTERVAL);
+  CHECK(reads >= 9 && reads <= 11);
+  twi.fail = false;
+  run(rtc, INTERVAL + 1);
+  CHECK(near(rtc.get_time()));
+
+  // Device behind; slowed down, never stepped backwards, absorbed
+  // within the interval per second at the slew trim (5000 ppm)
+  device(device_time - 5);
+  run(rtc, INTERVAL + 5 * 200 + INTERVAL);
+  CHECK(near(rtc.get_time()));
+
+  // Device ahead; stepped forward on the next synchronization
+  device(device_time + 100);
+  run(rtc, INTERVAL + 1);
+  CHECK(near(rtc.get_time()));
+
+  return (report("hybrid"));
+}
@@ -0,0 +1,214 @@
+/**
+ * @file test_isotime.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+#include "Hardware/AVR/zones.h"
+#include "ref.h"
+
+/**
+ * Fuzz test of isotime_parse(); random and mutated ISO 8601 strings
+ * parsed and compared with a reference parser, and the time stamps
+ * compared with the C library, with and without zone designator.
+ * Strings outside the time_t range should give NULL. Local time in
+ * a given time zone, isotime_parse_z(), compared with localtime_z().
+ */
+
+static uint32_t errors = 0;
+static uint32_t checks = 0;
+
+/**
+ * Return next pseudo-random number (xorshift64).
+ * @return random number.
+ */
+static uint64_t next()
+{
+  static uint64_t x = 88172645463325252ULL;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  return (x);
+}
+
+/**
+ * Return true(1) if the given time stamp is in the time_t range,
+ * otherwise false(0).
+ * @param[in] time seconds from epoch.
+ * @return bool.
+ */
+static bool in_range(int64_t time)
+{
+#if TIME_64
+  (void) time;
+  return (true);
+#else
+  return (time >= 0 && time <= UINT32_MAX);
+#endif
+}
+
+/**
+ * Parse the given string with isotime_parse() and the reference
+ * parser and compare; the fields, the length, and the time stamp
+ * with the given time zone.
+ * @param[in] buf string to parse.
+ * @param[in] zone local time zone offset (seconds).
+ */
+static void check(const char* buf, int32_t zone)
+{
+  struct tm now;
+  int32_t offset = -1;
+  uint16_t ms = 0xffff;
+  ref_iso_t ref;
+  const char* res = isotime_parse(buf, &now, &offset, &ms);
+  int len = ref_isotime_parse(buf, &ref);
+  checks++;
+  if ((res == NULL) != (len < 0)) {
+    if (errors++ < 8)
+      printf("isotime_parse(\"%s\"): %d vs %d\n", buf,
+	     res == NULL ? -1 : (int) (res - buf), len);
+    return;
+  }
+  if (res == NULL) return;
+  if ((res - buf) != len
+      || now.tm_sec != ref.tm.sec || now.tm_min != ref.tm.min
+      || now.tm_hour != ref.tm.hour || now.tm_mday != ref.tm.mday
+      || now.tm_wday != ref.tm.wday || now.tm_mon != ref.tm.mon
+      || now.tm_year != ref.tm.year || now.tm_yday != ref.tm.yday
+      || ms != ref.ms
+      || offset != (ref.zone ? ref.offset : -1)) {
+    if (errors++ < 8)
+      printf("isotime_parse(\"%s\"): fields\n", buf);
+    return;
+  }
+
+  // Time stamp; zone designator or local time
+  int64_t expect = ref_timegm(&ref.tm) - (ref.zone ? ref.offset : zone);
+  time_t time = 0;
+  res = isotime_parse(buf, &time, NULL);
+  checks++;
+  if (!in_range(expect)) {
+    if (res != NULL && errors++ < 8)
+      printf("isotime_parse(\"%s\"): %lld outside range\n", buf,
+	     (long long) time);
+  }
+  else if ((res == NULL || time != expect) && errors++ < 8)
+    printf("isotime_parse(\"%s\"): %lld vs %lld\n", buf,
+	   res == NULL ? -1LL : (long long) time, (long long) expect);
+}
+
+/**
+ * Check that the given string gives the given time stamp, or NULL
+ * when outside the time_t range.
+ * @param[in] buf string to parse.
+ * @param[in] expect seconds from epoch.
+ */
+static void check_range(const char* buf, int64_t expect)
+{
+  time_t time = 0;
+  const char* res = isotime_parse(buf, &time, NULL);
+  checks++;
+  if (in_range(expect) ? (res == NULL || time != expect) : (res != NULL)) {
+    if (errors++ < 8)
+      printf("isotime_parse(\"%s\"): %lld\n", buf,
+	     res == NULL ? -1LL : (long long) time);
+  }
+}
+
+/**
+ * Check that the local time of the given time stamp in the given
+ * time zone is parsed back to the time stamp; in the repeated hour
+ * at the end of Daylight Saving to a time stamp with the same local
+ * time.
+ * @param[in] time seconds from epoch.
+ * @param[in] zone time zone.
+ */
+static void check_zone(time_t time, zone_t* zone)
+{
+  struct tm now;
+  char buf[32];
+  char expect[32];
+  time_t res = 0;
+  localtime_z(&time, &now, zone);
+  isotime_r(&now, expect);
+  const char* end = isotime_parse_z(expect, &res, NULL, zone);
+  int64_t diff = (int64_t) res - (int64_t) time;
+  checks++;
+  if (end == NULL || *end != 0
+      || (res != time
+	  && (diff > ONE_HOUR || diff < -ONE_HOUR
+	      || strcmp(isotime_r(localtime_z(&res, &now, zone), buf),
+			expect)))) {
+    if (errors++ < 8)
+      printf("isotime_parse_z(\"%s\"): %lld vs %lld\n", expect,
+	     (long long) res, (long long) time);
+  }
+}
+
+int main()
+{
+  static const char ALPHA[] = "0123456789-:T Z+.,";
+  static const char* ZONE[] = {
+    "Z", "+01:00", "-0530", "+02", "", "+2", "+01:7", "-23:59", "x"
+  };
+  static const int32_t LOCAL[] = { 0, 3600, -5 * 3600 };
+
+  // The time_t range limits
+  set_zone(0);
+  set_dst(NULL);
+  check_range("2000-01-01T00:00:00Z", 0LL);
+  check_range("2000-01-01T00:00+01:00", -3600LL);
+  check_range("1999-12-31T23:59:59Z", -1LL);
+  check_range("1999-12-31T19:00-05:00", 0LL);
+  check_range("2136-02-07T06:28:15Z", 4294967295LL);
+  check_range("2136-02-07T06:28:16Z", 4294967296LL);
+  check_range("2136-02-07T07:28:15+01:00", 4294967295LL);
+  check_range("2136-02-07T06:28:15-00:01", 4294967355LL);
+
+  // Random strings; truncated and mutated
+  for (uint32_t i = 0; i < 3000000; i++) {
+    char buf[64];
+    int n = snprintf(buf, sizeof(buf), "%04d-%02d-%02d%c%02d:%02d:%02d.%d%s",
+		     (int) (next() % 10000), (int) (next() % 14),
+		     (int) (next() % 33), "T T"[next() % 3],
+		     (int) (next() % 26), (int) (next() % 62),
+		     (int) (next() % 62), (int) (next() % 100000),
+		     ZONE[next() % (sizeof(ZONE) / sizeof(ZONE[0]))]);
+    if (next() % 3 == 0) n = next() % (n + 1);
+    buf[n] = 0;
+    if (n != 0 && next() % 4 == 0)
+      for (uint8_t j = next() % 3; j != 0; j--)
+	buf[next() % n] = ALPHA[next() % (sizeof(ALPHA) - 1)];
+    int32_t zone = LOCAL[i % (sizeof(LOCAL) / sizeof(LOCAL[0]))];
+    set_zone(zone);
+    check(buf, zone);
+  }
+
+  // Local time in Central European Time; the global time zone is
+  // not used
+  zone_t cet;
+  zone_init_P(&cet, &zone_cet);
+  set_zone(-5 * ONE_HOUR);
+  for (uint32_t i = 0; i < 1000000; i++)
+    check_zone(ONE_DAY + next() % (UINT32_MAX - 2 * ONE_DAY), &cet);
+  time_t start = 536457600UL;
+  for (time_t t = start; t < start + 366 * (time_t) ONE_DAY; t += 60)
+    check_zone(t, &cet);
+
+  printf("isotime: %lu checks, %lu errors\n", (unsigned long) checks,
+	 (unsigned long) errors);
+  return (errors != 0);
+}
@@ -0,0 +1,92 @@
+/**
+ * @file test_isotime_r.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+
+/**
+ * Test of isotime_r() and isotime_len() with the two digit lookup
+ * table; compared with the original __print_lz based formatting for
+ * all years in struct tm and all values of the other fields, and
+ * with snprintf() for years 0..9999.
+ */
+
+// Original formatting; ISOTIME_R_TABLE disabled
+namespace original {
+#undef ISOTIME_R_TABLE
+#define ISOTIME_R_TABLE 0
+#include "Hardware/AVR/print_lz.cpp"
+#include "Hardware/AVR/isotime_r.cpp"
+};
+
+static uint32_t errors = 0;
+static uint32_t checks = 0;
+
+int main()
+{
+  struct tm now(SATURDAY, 0, JANUARY, 1, 0, 0, 0);
+
+  for (int32_t year = INT16_MIN; year <= INT16_MAX; year++) {
+    char buf[32];
+    char expect[32];
+    now.tm_year = year;
+    now.tm_mon = year & 7;
+    now.tm_mday = (year & 15) + 1;
+    now.tm_hour = year % 24 + 23 * (year < 0);
+    now.tm_min = (year & 63) % 60;
+    now.tm_sec = (year >> 6 & 63) % 60;
+    memset(buf, 'x', sizeof(buf));
+    original::isotime_r(&now, expect);
+    checks++;
+    if ((isotime_len(&now, buf) != 19 || strcmp(buf, expect) != 0
+	 || buf[20] != 'x') && errors++ < 8)
+      printf("isotime_len(%ld): \"%s\" vs \"%s\"\n", (long) year + 1900,
+	     buf, expect);
+    if (year + 1900 < 0 || year + 1900 > 9999) continue;
+    snprintf(expect, sizeof(expect), "%04d-%02d-%02d %02d:%02d:%02d",
+	     (int) year + 1900, now.tm_mon + 1, now.tm_mday, now.tm_hour,
+	     now.tm_min, now.tm_sec);
+    checks++;
+    if (strcmp(isotime_r(&now, buf), expect) != 0 && errors++ < 8)
+      printf("isotime_r(%ld): \"%s\" vs \"%s\"\n", (long) year + 1900,
+	     buf, expect);
+  }
+
+  // Fields that are not normalized; all values of each field
+  for (uint8_t field = 0; field < 5; field++) {
+    for (int16_t value = INT8_MIN; value <= INT8_MAX; value++) {
+      struct tm tm(SATURDAY, 2017, JANUARY, 1, 0, 0, 0);
+      int8_t* fp[] = {
+	&tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec
+      };
+      char buf[32];
+      char expect[32];
+      *fp[field] = value;
+      memset(buf, 'x', sizeof(buf));
+      original::isotime_r(&tm, expect);
+      checks++;
+      if ((isotime_len(&tm, buf) != 19 || strcmp(buf, expect) != 0
+	   || buf[20] != 'x') && errors++ < 8)
+	printf("isotime_len(field %u = %d): \"%s\" vs \"%s\"\n", field,
+	       value, buf, expect);
+    }
+  }
+
+  printf("isotime_r: %lu checks, %lu errors\n", (unsigned long) checks,
+	 (unsigned long) errors);
+  return (errors != 0);
+}
@@ -0,0 +1,163 @@
+/**
+ * @file test_isr.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+#include <signal.h>
+#include <ucontext.h>
+
+/**
+ * Test of the interrupt driven software real-time clock. The clock
+ * functions are single-stepped (x86-64 trap flag), and the tick
+ * interrupt is raised after the n:th instruction, for each n until
+ * the function returns. The interrupt is pending while interrupts
+ * are disabled in the critical sections. The clock is set to one
+ * second before new year so that the tick changes all fields of the
+ * calendar. Checks that the calendar is consistent with the seconds
+ * counter (no torn reads or writes), and that no ticks are lost.
+ */
+
+static CalendarRTC rtc;
+
+// Number of ticks
+static volatile uint32_t ticks;
+
+// Instruction count and instruction to raise the interrupt after
+static volatile uint32_t step;
+static volatile uint32_t inject;
+
+/**
+ * Tick interrupt service routine.
+ */
+static void isr()
+{
+  rtc.tick_isr();
+  ticks = ticks + 1;
+}
+
+/**
+ * Trap signal handler; raise tick interrupt after the given
+ * instruction.
+ */
+static void trap(int, siginfo_t*, void*)
+{
+  if (step++ == inject) host_interrupt(isr);
+}
+
+/** Start single-stepping; set trap flag. */
+#define TRACE_ON()							\
+  __asm__ __volatile__("pushfq\n\torq $0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc")
+
+/** Stop single-stepping; clear trap flag. */
+#define TRACE_OFF()							\
+  __asm__ __volatile__("pushfq\n\tandq $~0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc")
+
+// Clock set to one second before new year
+static const struct tm NEW_YEAR(SATURDAY, 2016, DECEMBER, 31, 23, 59, 59);
+
+static uint32_t errors = 0;
+
+/**
+ * Check that the calendar of the clock is consistent with the given
+ * time, and the seconds counter. The ticks before the call are lost
+ * when the clock is set.
+ * @param[in] fn name of function.
+ * @param[in] now broken-down time.
+ * @param[in] before seconds counter before the call.
+ * @param[in] after seconds counter after the call.
+ * @param[in] set clock set in the call.
+ */
+static void check(const char* fn, const struct tm& now,
+		  time_t before, time_t after, bool set = false)
+{
+  struct tm cal, expected;
+  time_t time = mk_gmtime((struct tm*) &now);
+  gmtime_r(&time, &expected);
+  rtc.get_time(cal);
+  time_t counter = rtc.get_time();
+  if (time < before || time > after
+      || memcmp(&now, &expected, sizeof(now))
+      || mk_gmtime(&cal) != counter
+      || (!set && counter - before != ticks)
+      || counter > after) {
+    if (errors++ < 8)
+      printf("%s: interrupt after instruction %u: %lu <= %lu <= %lu\n",
+	     fn, inject, (unsigned long) before, (unsigned long) time,
+	     (unsigned long) after);
+  }
+}
+
+int main()
+{
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_sigaction = trap;
+  sa.sa_flags = SA_SIGINFO;
+  sigaction(SIGTRAP, &sa, NULL);
+  struct tm start = NEW_YEAR;
+  time_t begin = mk_gmtime(&start);
+  uint32_t steps;
+
+  // Read calendar; interrupt after each instruction
+  for (inject = 0;; inject++) {
+    rtc.set_time(begin);
+    ticks = 0;
+    step = 0;
+    struct tm now;
+    TRACE_ON();
+    rtc.get_time(now);
+    TRACE_OFF();
+    if (inject >= step) break;
+    check("get_time(tm)", now, begin, begin + 1);
+  }
+  steps = inject;
+
+  // Read seconds and milliseconds
+  for (inject = 0;; inject++) {
+    rtc.set_time(begin);
+    ticks = 0;
+    step = 0;
+    uint16_t ms;
+    TRACE_ON();
+    time_t time = rtc.get_time(ms);
+    TRACE_OFF();
+    if (inject >= step) break;
+    struct tm now;
+    gmtime_r(&time, &now);
+    check("get_time(ms)", now, begin, begin + 1);
+  }
+  steps += inject;
+
+  // Set time; the seconds counter and calendar are set together
+  for (inject = 0;; inject++) {
+    rtc.set_time(0);
+    ticks = 0;
+    step = 0;
+    TRACE_ON();
+    rtc.set_time(begin);
+    TRACE_OFF();
+    if (inject >= step) break;
+    struct tm now;
+    rtc.get_time(now);
+    check("set_time", now, begin, begin + 1, true);
+  }
+  steps += inject;
+
+  printf("isr: %lu interrupt points, %lu errors\n",
+	 (unsigned long) steps, (unsigned long) errors);
+  return (errors != 0);
+}
@@ -0,0 +1,107 @@
+/**
+ * @file test_ramcache.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+#include "test.h"
+#include "TWI.h"
+#include "Driver/DS1307.h"
+#include "RAMCache.h"
+
+/**
+ * Test of the write-back cache of the DS1307 static memory on the
+ * mock TWI bus; the cache is at the start of the static memory, the
+ * clock registers are not written, reads are served from the cache,
+ * and each flush is a single transaction with the changed range.
+ */
+
+int main()
+{
+  TWI twi;
+  DS1307 rtc(twi);
+  RAMCache<DS1307> cache(rtc);
+  uint8_t* ram = twi.mem + DS1307::RAM_START;
+  uint8_t model[DS1307::RAM_MAX];
+  uint8_t clock[DS1307::RAM_START];
+
+  for (size_t i = 0; i < sizeof(twi.mem); i++) twi.mem[i] = next();
+  memcpy(clock, twi.mem, sizeof(clock));
+  memcpy(model, ram, sizeof(model));
+
+  // Default address is the start of the static memory
+  CHECK(cache.begin());
+  CHECK(twi.transactions == 2);
+  for (uint8_t i = 0; i < cache.RAM_MAX; i++)
+    CHECK(cache.read_ram(i) == model[i]);
+  CHECK(twi.transactions == 2 && !cache.is_dirty());
+
+  // Unchanged writes are not pending
+  cache.write_ram(3, model[3]);
+  CHECK(!cache.is_dirty());
+  CHECK(cache.flush() && twi.transactions == 2);
+
+  // Blocks outside the cache
+  uint8_t buf[8];
+  CHECK(!cache.read_ram(cache.RAM_MAX - 4, buf, sizeof(buf)));
+  CHECK(!cache.write_ram(cache.RAM_MAX - 4, buf, sizeof(buf)));
+  CHECK(cache.read_ram(cache.RAM_MAX) == 0);
+
+  // Failed flush is kept pending
+  cache.write_ram(10, model[10] ^ 1);
+  model[10] ^= 1;
+  twi.fail = true;
+  CHECK(!cache.flush() && cache.is_dirty());
+  twi.fail = false;
+  CHECK(ram[10] != model[10]);
+  CHECK(cache.flush() && !cache.is_dirty() && ram[10] == model[10]);
+
+  // Random writes; each flush is one transaction with the changed
+  // range and the register address
+  for (uint16_t i = 0; i < 10000; i++) {
+    uint8_t first = cache.RAM_MAX;
+    uint8_t last = 0;
+    for (uint8_t n = next() % 5; n != 0; n--) {
+      uint8_t addr = next() % cache.RAM_MAX;
+      uint8_t data = (next() % 4 == 0) ? model[addr] : next();
+      cache.write_ram(addr, data);
+      if (model[addr] != data) {
+	if (addr < first) first = addr;
+	if (addr > last) last = addr;
+      }
+      model[addr] = data;
+    }
+    uint32_t transactions = twi.transactions;
+    uint32_t bytes = twi.bytes;
+    CHECK(cache.is_dirty() == (first < cache.RAM_MAX));
+    CHECK(cache.flush());
+    if (first < cache.RAM_MAX) {
+      CHECK(twi.transactions == transactions + 1);
+      CHECK(twi.bytes == bytes + last - first + 2);
+    }
+    else {
+      CHECK(twi.transactions == transactions);
+    }
+    CHECK(!memcmp(ram, model, sizeof(model)));
+  }
+  CHECK(!memcmp(twi.mem, clock, sizeof(clock)));
+
+  // Begin discards pending writes
+  cache.write_ram(0, model[0] ^ 0xff);
+  CHECK(cache.begin() && !cache.is_dirty() && cache.read_ram(0) == model[0]);
+
+  return (report("ramcache"));
+}
@@ -0,0 +1,119 @@
+/**
+ * @file test_record.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+#include "test.h"
+#include "TWI.h"
+#include "Driver/DS1307.h"
+#include "Record.h"
+
+/**
+ * Test of the record store in the DS1307 static memory on the mock
+ * TWI bus; cleared memory, commit and restore over the sequence
+ * number wrap, failed and corrupted writes.
+ */
+
+/** Record type. */
+struct state_t {
+  uint32_t count;
+  uint8_t mode;
+  uint8_t data[8];
+};
+
+typedef Record<DS1307, state_t> Store;
+
+// Size of slot; record, sequence number and CRC
+static const size_t SLOT = sizeof(state_t) + 2;
+
+/**
+ * Return true(1) if a new store on the device restores the given
+ * record, otherwise false(0).
+ * @param[in] rtc device.
+ * @param[in] expect record.
+ * @return bool.
+ */
+static bool restores(DS1307& rtc, const state_t& expect)
+{
+  Store store(rtc, DS1307::RAM_START);
+  return (store.begin() && !memcmp(&store.data(), &expect, sizeof(expect)));
+}
+
+int main()
+{
+  TWI twi;
+  DS1307 rtc(twi);
+  uint8_t* mem = twi.mem + DS1307::RAM_START;
+
+  // Cleared and erased memory is not a valid record
+  Store store(rtc, DS1307::RAM_START);
+  CHECK(!store.begin());
+  memset(mem, 0xff, Store::SIZE);
+  CHECK(!store.begin());
+  memset(mem, 0, Store::SIZE);
+
+  // Commit and restore; random changes over the sequence number wrap
+  state_t state;
+  memset(&state, 0, sizeof(state));
+  for (uint16_t i = 0; i < 600; i++) {
+    state_t& data = store.data();
+    data.count += 1;
+    if (next() % 3 == 0) data.mode = next();
+    if (next() % 4 == 0) data.data[next() % sizeof(data.data)] = next();
+    state = data;
+    uint8_t seq = store.sequence();
+    CHECK(store.commit());
+    CHECK(i == 0 || store.sequence() == (uint8_t) (seq + 1));
+    CHECK(restores(rtc, state));
+  }
+
+  // No write when unchanged
+  uint32_t transactions = twi.transactions;
+  CHECK(store.commit() && twi.transactions == transactions);
+
+  // Failed write; the latest commit is restored, and rollback
+  state_t latest = state;
+  store.data().count += 1;
+  twi.fail = true;
+  CHECK(!store.commit());
+  twi.fail = false;
+  CHECK(restores(rtc, latest));
+  CHECK(store.rollback() && store.data().count == latest.count);
+
+  // Corrupted latest slot, e.g. interrupted write; previous commit is
+  // restored
+  state_t previous = latest;
+  store.data().count += 1;
+  CHECK(store.commit());
+  latest = store.data();
+  uint8_t slot = (store.sequence() & 1) ? 0 : 1;
+  for (size_t i = 0; i < SLOT; i++) {
+    uint8_t& byte = mem[(slot ^ 1) * SLOT + i];
+    byte ^= 0x01;
+    CHECK(restores(rtc, previous));
+    byte ^= 0x01;
+  }
+  CHECK(restores(rtc, latest));
+
+  // Both slots corrupted
+  mem[0] ^= 0x80;
+  mem[SLOT] ^= 0x80;
+  Store none(rtc, DS1307::RAM_START);
+  CHECK(!none.begin());
+
+  return (report("record"));
+}
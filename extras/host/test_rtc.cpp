@@ -0,0 +1,85 @@
+/**
+ * @file test_rtc.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+#include "test.h"
+
+/**
+ * Test of the software real-time clock time stamps with clock trim.
+ * The milliseconds are advanced in random steps and the clock is
+ * updated with tick() or update() at random intervals. Checks that
+ * the time stamps are monotonic, the milliseconds are within the
+ * second, and that update() counts the trimmed seconds.
+ */
+
+/**
+ * Run the clock with the given trim for the given number of
+ * milliseconds, with the given max interval between updates.
+ * @param[in] ppm clock trim.
+ * @param[in] duration milliseconds.
+ * @param[in] interval max milliseconds between updates; tick()
+ *   when less than a second, otherwise update().
+ */
+static void run(int16_t ppm, uint32_t duration, uint32_t interval)
+{
+  RTC rtc;
+  rtc.trim(ppm);
+  rtc.set_time(1000);
+  host_millis = 0;
+  rtc.tick();
+  timestamp_t prev = rtc.get_timestamp();
+  uint32_t start = host_millis;
+  uint32_t update = start + next() % interval;
+  while (host_millis - start < duration) {
+    host_millis += 1 + next() % 7;
+    if ((int32_t) (host_millis - update) >= 0) {
+      if (interval > 1000) rtc.update();
+      else while (rtc.tick());
+      update = host_millis + next() % interval;
+    }
+    uint16_t ms;
+    time_t time = rtc.get_time(ms);
+    timestamp_t now = rtc.get_timestamp();
+    CHECK(ms < 1000);
+    CHECK(now >= prev);
+    CHECK(timestamp_time(now) >= time);
+    prev = now;
+  }
+
+  // Trimmed seconds with update(); within one second of the elapsed
+  // time. The tick() remainder is dropped
+  rtc.update();
+  int64_t expected = (duration * 1000LL) / (1000 + ppm / 1000.0) / 1000;
+  int64_t seconds = rtc.get_time() - 1000;
+  if (interval > 1000)
+    CHECK(seconds >= expected - 1 && seconds <= expected + 1);
+}
+
+int main()
+{
+  static const int16_t TRIM[] = {
+    -10000, -5000, -999, 0, 999, 1001, 5000, 10000
+  };
+  for (size_t i = 0; i < sizeof(TRIM) / sizeof(TRIM[0]); i++) {
+    run(TRIM[i], 200000UL, 100);
+    run(TRIM[i], 200000UL, 1000);
+    run(TRIM[i], 200000UL, 1500);
+    run(TRIM[i], 200000UL, 5000);
+  }
+  return (report("rtc"));
+}
@@ -0,0 +1,125 @@
+/**
+ * @file test_strftime.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+#include "Hardware/AVR/zones.h"
+#include "test.h"
+#include "ref.h"
+
+/**
+ * Test of strftime() compared with the C library strftime(); all
+ * conversions, for every day of the time_t range at a random time of
+ * day, and random time stamps. With TIME_64 the years 1000-9999, as
+ * the C library does not pad years to four digits. %s of local time
+ * in a given time zone, strftime_z() and strftime_put_z().
+ */
+
+#if TIME_64
+static const int16_t FIRST = 1000;
+static const int16_t LAST = 9999;
+#else
+static const int16_t FIRST = 2000;
+static const int16_t LAST = 2135;
+#endif
+
+// All conversions
+static const char FORMAT[] =
+  "%a %b %d %e %F %G %H %I %j %m %M %p %s %S %T %u %V %w %y %Y %% %q";
+
+/**
+ * Compare strftime() of the given time stamp with the C library.
+ * @param[in] time seconds from epoch.
+ */
+static void check(time_t time)
+{
+  struct tm now;
+  ref_tm_t ref;
+  char buf[128];
+  char expect[128];
+  gmtime_r(&time, &now);
+  ref_gmtime(time, &ref);
+  size_t n = strftime(buf, sizeof(buf), FORMAT, &now);
+  size_t m = ref_strftime(expect, sizeof(expect), FORMAT, &ref);
+  CHECK(n == m && !strcmp(buf, expect));
+  if (strcmp(buf, expect) && errors < 8)
+    printf("\"%s\" vs \"%s\"\n", buf, expect);
+}
+
+/**
+ * Check that %s of the local time of the given time stamp in the
+ * given time zone is the time stamp (seconds from UNIX epoch).
+ * @param[in] time seconds from epoch.
+ * @param[in] zone time zone.
+ */
+static void check_zone(time_t time, zone_t* zone)
+{
+  struct tm now;
+  char buf[32];
+  char expect[32];
+  size_t count = 0;
+  localtime_z(&time, &now, zone);
+  snprintf(expect, sizeof(expect), "%lld",
+	   (long long) time + (long long) UNIX_OFFSET);
+  CHECK(strftime_z(buf, sizeof(buf), "%s", &now, zone) == strlen(expect)
+	&& !strcmp(buf, expect));
+  CHECK(strftime_put_z([](void* arg, char) { (*(size_t*) arg)++; },
+		       &count, "%s", &now, zone) == strlen(expect)
+	&& count == strlen(expect));
+  if (strcmp(buf, expect) && errors < 8)
+    printf("\"%s\" vs \"%s\"\n", buf, expect);
+}
+
+int main()
+{
+  struct tm first(SATURDAY, FIRST, JANUARY, 1, 0, 0, 0);
+  struct tm last(SATURDAY, LAST + 1, JANUARY, 1, 0, 0, 0);
+  time_t start = mk_gmtime(&first);
+  time_t stop = mk_gmtime(&last);
+
+  // The C library %s is local time; the library time zone is UTC
+  ref_tz("UTC0");
+
+  // Every day; ISO 8601 weeks at the turn of the years
+  for (time_t t = start; t < stop; t += ONE_DAY)
+    check(t + next() % ONE_DAY);
+
+  // Random time stamps; within the range and at the limits
+  for (uint32_t i = 0; i < 1000000; i++)
+    check(start + next() % (uint64_t) (stop - start));
+  check(start);
+  check(stop - 1);
+
+  // Truncated output
+  struct tm now;
+  char buf[8];
+  gmtime_r(&start, &now);
+  memset(buf, 'x', sizeof(buf));
+  CHECK(strftime(buf, 5, "%F", &now) == 0 && buf[5] == 'x');
+
+  // Local time in Central European Time; the global time zone is
+  // not used
+  zone_t cet;
+  zone_init_P(&cet, &zone_cet);
+  set_zone(-5 * ONE_HOUR);
+  for (uint32_t i = 0; i < 1000000; i++)
+    check_zone(start + ONE_DAY + next() % (uint64_t) (stop - start - 2 * ONE_DAY),
+	       &cet);
+  set_zone(0);
+
+  return (report("strftime"));
+}
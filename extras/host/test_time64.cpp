@@ -0,0 +1,141 @@
+/**
+ * @file test_time64.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+#include "ref.h"
+
+/**
+ * Test of the 64-bit time_t (TIME_64) conversion; gmtime_r() and
+ * mk_gmtime() compared with the C library over +-10,000 years from
+ * the epoch, the signed time stamps, and difftime().
+ */
+
+// Seconds in 10,000 years
+static const int64_t RANGE = 10000LL * 146097LL * ONE_DAY / 400;
+
+static uint32_t errors = 0;
+static uint32_t checks = 0;
+
+/**
+ * Return next pseudo-random number (xorshift64).
+ * @return random number.
+ */
+static uint64_t next()
+{
+  static uint64_t x = 88172645463325252ULL;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  return (x);
+}
+
+/**
+ * Compare gmtime_r() and mk_gmtime() of the given time stamp with
+ * the C library.
+ * @param[in] time seconds from epoch.
+ */
+static void check(time_t time)
+{
+  struct tm now;
+  ref_tm_t ref;
+  gmtime_r(&time, &now);
+  ref_gmtime(time, &ref);
+  checks++;
+  if (now.tm_sec != ref.sec || now.tm_min != ref.min
+      || now.tm_hour != ref.hour || now.tm_mday != ref.mday
+      || now.tm_wday != ref.wday || now.tm_mon != ref.mon
+      || now.tm_year != ref.year || now.tm_yday != ref.yday) {
+    if (errors++ < 8)
+      printf("gmtime_r(%lld): %d-%d-%d %d vs %d-%d-%d %d\n",
+	     (long long) time, now.tm_year, now.tm_mon, now.tm_mday,
+	     now.tm_yday, ref.year, ref.mon, ref.mday, ref.yday);
+  }
+  if (mk_gmtime(&now) != time && errors++ < 8)
+    printf("mk_gmtime(%lld): %lld\n", (long long) time,
+	   (long long) mk_gmtime(&now));
+}
+
+/**
+ * Check that the time stamp of the given time and milliseconds gives
+ * the time and milliseconds back.
+ * @param[in] time seconds from epoch.
+ * @param[in] ms milliseconds.
+ */
+static void check(time_t time, uint16_t ms)
+{
+  timestamp_t ts = mk_timestamp(time, ms);
+  checks++;
+  if ((timestamp_time(ts) != time || timestamp_ms(ts) != ms)
+      && errors++ < 8)
+    printf("timestamp(%lld, %u): %lld, %u\n", (long long) time, ms,
+	   (long long) timestamp_time(ts), timestamp_ms(ts));
+}
+
+int main()
+{
+  // Each day at a varying time of day, and each midnight
+  const int64_t DAYS = RANGE / ONE_DAY;
+  for (int64_t day = -DAYS; day <= DAYS; day++) {
+    time_t midnight = day * (time_t) ONE_DAY;
+    check(midnight + (day * 7919 % 86400 + 86400) % 86400);
+    check(midnight);
+    check(midnight - 1);
+  }
+
+  // Random time stamps
+  for (uint32_t i = 0; i < 10000000; i++)
+    check((time_t) (next() % (2 * RANGE)) - RANGE);
+
+  // mk_gmtime() with fields out of range compared with timegm()
+  for (uint32_t i = 0; i < 5000000; i++) {
+    struct tm now;
+    ref_tm_t ref;
+    ref.year = now.tm_year = next() % 20000 - 9000;
+    ref.mon = now.tm_mon = next() % 50 - 20;
+    ref.mday = now.tm_mday = next() % 70 - 15;
+    ref.hour = now.tm_hour = next() % 50 - 10;
+    ref.min = now.tm_min = next() % 120 - 30;
+    ref.sec = now.tm_sec = next() % 120 - 30;
+    time_t time = mk_gmtime(&now);
+    checks++;
+    if (time != ref_timegm(&ref) && errors++ < 8)
+      printf("mk_gmtime(%d-%d-%d): %lld vs %lld\n", ref.year, ref.mon,
+	     ref.mday, (long long) time, (long long) ref_timegm(&ref));
+  }
+
+  // Signed time stamps before and after the epoch
+  for (time_t time = -3 * (time_t) ONE_DAY; time <= 3 * (time_t) ONE_DAY;
+       time += 997)
+    for (uint16_t ms = 0; ms < 1000; ms += 37)
+      check(time, ms);
+  check(-RANGE, 999);
+  check(RANGE, 0);
+  if (timestamp_time(mk_timestamp(-86400, 0)) != -86400) errors++;
+  if (timestamp_time(mk_timestamp(-1, 500)) != -1) errors++;
+  if (mk_timestamp(-1, 500) >= mk_timestamp(0, 0)) errors++;
+
+  // Differences beyond the 32-bit range
+  if (difftime(RANGE, -RANGE) != 2 * RANGE) errors++;
+  if (difftime(-RANGE, RANGE) != -2 * RANGE) errors++;
+  if (difftime(100LL * 365 * ONE_DAY, 0) != 100LL * 365 * ONE_DAY) errors++;
+  checks += 3;
+
+  printf("time64: %lu checks, %lu errors\n", (unsigned long) checks,
+	 (unsigned long) errors);
+  return (errors != 0);
+}
@@ -0,0 +1,199 @@
+/**
+ * @file test_zone.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "RTC.h"
+#include "test.h"
+#include "ref.h"
+
+/**
+ * Test of the compiled time zone rules; zone_parse(), and
+ * localtime_z(), mktime_z() and zone_dst() compared with the C
+ * library with the same POSIX TZ string. Northern and southern
+ * hemisphere rules, 30 and 45 minute offsets and Daylight Saving,
+ * and negative and beyond 24 hour transition times. Every hour of
+ * the years, and every second of the hours with a transition. TZ
+ * strings that are not supported are rejected.
+ */
+
+// Years; the C library evaluates TZ string rules from 1970
+#if TIME_64
+static const int16_t FIRST = 1971;
+static const int16_t LAST = 2199;
+#else
+static const int16_t FIRST = 2000;
+static const int16_t LAST = 2135;
+#endif
+
+/**
+ * Return true(1) if the given broken-down times are equal, otherwise
+ * false(0).
+ * @param[in] now broken-down time.
+ * @param[in] ref C library broken-down time.
+ * @return bool.
+ */
+static bool equal(const struct tm& now, const ref_tm_t& ref)
+{
+  return (now.tm_sec == ref.sec && now.tm_min == ref.min
+	  && now.tm_hour == ref.hour && now.tm_mday == ref.mday
+	  && now.tm_wday == ref.wday && now.tm_mon == ref.mon
+	  && now.tm_year == ref.year && now.tm_yday == ref.yday);
+}
+
+/**
+ * Compare localtime_z() of the given time stamp with the C library.
+ * Return Daylight Saving (seconds) of the C library.
+ * @param[in] tz TZ string.
+ * @param[in] zone time zone.
+ * @param[in] time seconds from epoch.
+ * @param[out] ref C library broken-down time.
+ * @return seconds.
+ */
+static int check_localtime(const char* tz, zone_t* zone, time_t time,
+			   ref_tm_t& ref)
+{
+  struct tm now;
+  int dst = ref_localtime(time, &ref);
+  localtime_z(&time, &now, zone);
+  int isdst = (zone->info.save == 0 ? -1 : dst);
+  CHECK(equal(now, ref) && now.tm_isdst == isdst);
+  if (!equal(now, ref) && errors < 8)
+    printf("%s: %lld: %d-%d-%d %d:%d vs %d-%d-%d %d:%d\n", tz,
+	   (long long) time, now.tm_year, now.tm_mon, now.tm_mday,
+	   now.tm_hour, now.tm_min, ref.year, ref.mon, ref.mday,
+	   ref.hour, ref.min);
+  return (dst);
+}
+
+/**
+ * Compare mktime_z() of the local time of the given time stamp with
+ * the C library; with tm_isdst given the time stamp is returned,
+ * otherwise the C library result, or the other occurrence of the
+ * local time at the end of Daylight Saving.
+ * @param[in] zone time zone.
+ * @param[in] time seconds from epoch.
+ * @param[in] ref C library broken-down local time.
+ * @param[in] dst C library Daylight Saving.
+ */
+static void check_mktime(zone_t* zone, time_t time, const ref_tm_t& ref,
+			 int dst)
+{
+  struct tm now(ref.wday, ref.year + 1900, ref.mon, ref.mday, ref.hour,
+		ref.min, ref.sec);
+  now.tm_isdst = (dst > 0);
+  CHECK(mktime_z(&now, zone) == time);
+  CHECK(equal(now, ref));
+  now = tm(ref.wday, ref.year + 1900, ref.mon, ref.mday, ref.hour,
+	   ref.min, ref.sec);
+  now.tm_isdst = -1;
+  time_t res = mktime_z(&now, zone);
+  int64_t other = ref_mktime(&ref, -1);
+  ref_tm_t local;
+  ref_localtime(other, &local);
+  if (res != other) ref_localtime(res, &local);
+  CHECK(equal(now, ref) && equal(now, local));
+}
+
+/**
+ * Compile the given TZ string and compare with the C library over
+ * the years; from the second day so that the local time is within
+ * the time_t range.
+ * @param[in] tz TZ string.
+ */
+static void check(const char* tz)
+{
+  zone_info_t info;
+  zone_t zone;
+  ref_tm_t ref;
+  CHECK(zone_parse(&info, tz) == 0);
+  zone_init(&zone, &info);
+  ref_tz(tz);
+  struct tm first(SATURDAY, FIRST, JANUARY, 1, 0, 0, 0);
+  struct tm last(SATURDAY, LAST + 1, JANUARY, 1, 0, 0, 0);
+  time_t stop = mk_gmtime(&last);
+  time_t start = mk_gmtime(&first) + ONE_DAY;
+  int prev = ref_localtime(start, &ref);
+  for (time_t t = start; t < stop; t += ONE_HOUR) {
+    int dst = check_localtime(tz, &zone, t, ref);
+    check_mktime(&zone, t, ref, dst);
+    CHECK(zone_dst(&t, &zone) == (zone.info.save == 0 ? -1 : dst));
+    if (dst != prev) {
+      for (time_t s = t - ONE_HOUR + 1; s < t; s++) {
+	dst = check_localtime(tz, &zone, s, ref);
+	check_mktime(&zone, s, ref, dst);
+      }
+    }
+    prev = dst;
+  }
+}
+
+int main()
+{
+  // Supported TZ strings; the zones and rules of zones.h, and the
+  // extremes of the tz database
+  static const char* const ZONE[] = {
+    "UTC0",
+    "GMT0BST,M3.5.0/1,M10.5.0",
+    "CET-1CEST,M3.5.0,M10.5.0/3",
+    "CET-1CEST-2,M3.5.0,M10.5.0/3",
+    "EST5EDT,M3.2.0,M11.1.0",
+    "PST8PDT,M3.2.0,M11.1.0",
+    "NST3:30NDT,M3.2.0,M11.1.0",
+    "AEST-10AEDT,M10.1.0,M4.1.0/3",
+    "ACST-9:30ACDT,M10.1.0,M4.1.0/3",
+    "LHST-10:30LHDT-11,M10.1.0,M4.1.0",
+    "<+1245>-12:45<+1345>,M9.5.0/2:45,M4.1.0/3:45",
+    "IST-5:30",
+    "<+0545>-5:45",
+    "<+14>-14",
+    "<-12>12",
+    "<-02>2<-01>,M3.5.0/-1,M10.5.0/0",
+    "IST-2IDT,M3.4.4/26,M10.5.0",
+    "<-04>4<-03>,M9.1.6/24,M4.1.6/24",
+    "<-03>3<-02>,M3.5.0/-2,M10.5.0/-1",
+    "EST5EDT,M3.2.0/-167,M11.1.0/167"
+  };
+  for (size_t i = 0; i < sizeof(ZONE) / sizeof(ZONE[0]); i++)
+    check(ZONE[i]);
+
+  // Default rules are the USA rules; the C library uses posixrules
+  zone_info_t info, usa;
+  CHECK(zone_parse(&info, "PST8PDT") == 0);
+  CHECK(zone_parse(&usa, "PST8PDT,M3.2.0,M11.1.0") == 0);
+  CHECK(!memcmp(&info, &usa, sizeof(info)));
+
+  // Not supported; Jn and n rules, negative Daylight Saving, offsets
+  // not in quarter hours, beyond 24 hours, and transition times
+  // beyond 167 hours
+  static const char* const INVALID[] = {
+    "CET-1CEST,J86/2,J300/3",
+    "CET-1CEST,85/2,299/3",
+    "IST-1GMT0,M10.5.0,M3.5.0/1",
+    "LMT-0:53:28",
+    "XXX25",
+    "XXX-999",
+    "CET-1CEST-26,M3.5.0,M10.5.0/3",
+    "EST5EDT,M3.2.0/168,M11.1.0",
+    "EST5EDT,M3.2.0,M11.1.0/-999",
+    "CET-1CEST,M3.5.0,M10.5.0/3:00:30",
+    "CE-1"
+  };
+  for (size_t i = 0; i < sizeof(INVALID) / sizeof(INVALID[0]); i++)
+    CHECK(zone_parse(&info, INVALID[i]) == -1);
+
+  return (report("zone"));
+}
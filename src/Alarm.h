@@ -0,0 +1,244 @@
+/**
+ * @file Alarm.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef ALARM_H
+#define ALARM_H
+
+#include "RTC.h"
+
+/**
+ * Alarm; action to run at a given time, once or periodically. The
+ * alarms are scheduled and dispatched by an Alarm::Scheduler. The
+ * time scale is the same as the clock used for dispatch. Sub-class
+ * and implement run().
+ */
+class Alarm {
+public:
+  /**
+   * Construct unscheduled alarm.
+   */
+  Alarm() :
+    m_next(NULL),
+    m_when(0),
+    m_period(0),
+    m_scheduled(false)
+  {}
+
+  /**
+   * Alarm action; called by the scheduler when the alarm time has
+   * been reached. The action may schedule or cancel alarms.
+   */
+  virtual void run() = 0;
+
+  /**
+   * Return time of next alarm.
+   * @return time.
+   */
+  time_t when() const
+  {
+    return (m_when);
+  }
+
+  /**
+   * Return alarm period in seconds, zero for one-shot alarm.
+   * @return seconds.
+   */
+  uint32_t period() const
+  {
+    return (m_period);
+  }
+
+  /**
+   * Return true(1) if the alarm is scheduled, otherwise false(0).
+   * @return bool.
+   */
+  bool is_scheduled() const
+  {
+    return (m_scheduled);
+  }
+
+  /**
+   * Alarm scheduler; alarms are kept in a list sorted by time, so
+   * that dispatch only needs to check the first alarm. Scheduling
+   * inserts in order, and is linear with the number of scheduled
+   * alarms.
+   */
+  class Scheduler {
+  public:
+    /**
+     * Construct scheduler with no alarms.
+     */
+    Scheduler() :
+      m_head(NULL)
+    {}
+
+    /**
+     * Schedule one-shot alarm at the given time.
+     * @param[in] alarm to schedule.
+     * @param[in] when time of alarm.
+     */
+    void at(Alarm& alarm, time_t when)
+    {
+      schedule(alarm, when, 0);
+    }
+
+    /**
+     * Schedule periodic alarm with the given period. The first alarm
+     * is one period from the given time.
+     * @param[in] alarm to schedule.
+     * @param[in] seconds period.
+     * @param[in] now current time.
+     */
+    void every(Alarm& alarm, uint32_t seconds, time_t now)
+    {
+      schedule(alarm, now + seconds, seconds);
+    }
+
+    /**
+     * Schedule daily alarm at the given time of day. The first alarm
+     * is the next time of day after the given time.
+     * @param[in] alarm to schedule.
+     * @param[in] hour of alarm [0-23].
+     * @param[in] min minute of alarm [0-59].
+     * @param[in] now current time.
+     */
+    void daily(Alarm& alarm, uint8_t hour, uint8_t min, time_t now)
+    {
+      time_t when = now - time_of_day(now) + hour * 3600L + min * 60;
+      if (when <= now) when += ONE_DAY;
+      schedule(alarm, when, ONE_DAY);
+    }
+
+    /**
+     * Schedule weekly alarm on the given day of week and time of day.
+     * The first alarm is the next such time after the given time.
+     * @param[in] alarm to schedule.
+     * @param[in] wday day of week of alarm [0-6], e.g. MONDAY.
+     * @param[in] hour of alarm [0-23].
+     * @param[in] min minute of alarm [0-59].
+     * @param[in] now current time.
+     */
+    void weekly(Alarm& alarm, uint8_t wday, uint8_t hour, uint8_t min,
+		time_t now)
+    {
+      uint8_t days = (wday + 7 - weekday(now)) % 7;
+      time_t when = now - time_of_day(now) + days * ONE_DAY
+	+ hour * 3600L + min * 60;
+      if (when <= now) when += 7 * ONE_DAY;
+      schedule(alarm, when, 7 * ONE_DAY);
+    }
+
+    /**
+     * Cancel the given alarm. No action if not scheduled by this
+     * scheduler.
+     * @param[in] alarm to cancel.
+     */
+    void cancel(Alarm& alarm)
+    {
+      if (!alarm.m_scheduled) return;
+      Alarm** link = &m_head;
+      while (*link != NULL && *link != &alarm) link = &(*link)->m_next;
+      if (*link == NULL) return;
+      *link = alarm.m_next;
+      alarm.m_next = NULL;
+      alarm.m_scheduled = false;
+    }
+
+    /**
+     * Return time of the next alarm, or zero if no alarms are
+     * scheduled.
+     * @return time.
+     */
+    time_t next() const
+    {
+      return (m_head == NULL ? 0 : m_head->m_when);
+    }
+
+    /**
+     * Run all alarms that are due at the given time. Periodic alarms
+     * are rescheduled before they are run. Periodic alarms that have
+     * missed several periods, e.g. after the clock was set, are run
+     * once and rescheduled to the next period after the given time.
+     * Return number of alarms run.
+     * @param[in] now current time.
+     * @return number of alarms.
+     */
+    uint8_t dispatch(time_t now)
+    {
+      uint8_t count = 0;
+      while (m_head != NULL && m_head->m_when <= now) {
+	Alarm* alarm = m_head;
+	m_head = alarm->m_next;
+	alarm->m_next = NULL;
+	alarm->m_scheduled = false;
+	if (alarm->m_period != 0) {
+	  time_t when = alarm->m_when + alarm->m_period;
+	  if (when <= now)
+	    when += ((now - when) / alarm->m_period + 1) * alarm->m_period;
+	  schedule(*alarm, when, alarm->m_period);
+	}
+	alarm->run();
+	count += 1;
+      }
+      return (count);
+    }
+
+    /**
+     * Run all alarms that are due at the given broken-down time, e.g.
+     * read from a DS1302/DS1307 device. Return number of alarms run.
+     * @param[in] now current time.
+     * @return number of alarms.
+     */
+    uint8_t dispatch(const struct tm& now)
+    {
+      return (dispatch(mk_gmtime(&now)));
+    }
+
+  protected:
+    /** Scheduled alarms sorted by time. */
+    Alarm* m_head;
+
+    /**
+     * Insert the given alarm in time order. Alarms with the same time
+     * are run in the order they were scheduled.
+     * @param[in] alarm to schedule.
+     * @param[in] when time of alarm.
+     * @param[in] period seconds, zero for one-shot.
+     */
+    void schedule(Alarm& alarm, time_t when, uint32_t period)
+    {
+      cancel(alarm);
+      alarm.m_when = when;
+      alarm.m_period = period;
+      Alarm** link = &m_head;
+      while (*link != NULL && (*link)->m_when <= when)
+	link = &(*link)->m_next;
+      alarm.m_next = *link;
+      *link = &alarm;
+      alarm.m_scheduled = true;
+    }
+  };
+
+protected:
+  Alarm* m_next;		//!< Next scheduled alarm.
+  time_t m_when;		//!< Time of alarm.
+  uint32_t m_period;		//!< Period in seconds, or zero.
+  bool m_scheduled;		//!< Alarm scheduled.
+};
+
+#endif
@@ -27,10 +27,325 @@
 #endif
 
 /**
- * GPIO based device driver for DS1302, Trickle-Charge Timekeeping Chip.
+ * GPIO based transport for the DS1302 driver. The transfer functions
+ * are unrolled, and the clock is timed with the given minimum clock
+ * high and low time for the supply voltage; 250 ns at 5 V (default),
+ * and 1000 ns at 2 V. The chip select to clock setup time is 1 us at
+ * 5 V (default), and 4 us at 2 V (Table, AC Electrical
+ * Characteristics, pp. 4).
  * @param[in] CS_PIN chip select board pin.
  * @param[in] SDA_PIN serial data board pin.
  * @param[in] CLK_PIN clock board pin.
+ * @param[in] T_CH minimum clock high time (ns, default 250).
+ * @param[in] T_CL minimum clock low time (ns, default 250).
+ * @param[in] T_CC minimum chip select to clock setup time (ns,
+ *   default 1000).
+ */
+template<BOARD::pin_t CS_PIN, BOARD::pin_t SDA_PIN, BOARD::pin_t CLK_PIN,
+	 uint16_t T_CH = 250, uint16_t T_CL = 250, uint16_t T_CC = 1000>
+class DS1302GPIO {
+public:
+  /**
+   * Construct transport with the given pins. Initiate pins (output
+   * mode).
+   */
+  DS1302GPIO()
+  {
+    m_cs.output();
+    m_cs.low();
+    m_sda.output();
+    m_clk.output();
+    m_clk.low();
+  }
+
+  /**
+   * Assert chip select; start of transfer block. Waits for chip
+   * select to clock setup time.
+   */
+  void select()
+    __attribute__((always_inline))
+  {
+    m_cs.high();
+    delay<CC_CYCLES>();
+  }
+
+  /**
+   * Deassert chip select; end of transfer block.
+   */
+  void deselect()
+    __attribute__((always_inline))
+  {
+    m_cs.low();
+  }
+
+  /**
+   * Set data direction to input; read from device.
+   */
+  void input()
+    __attribute__((always_inline))
+  {
+    m_sda.input();
+  }
+
+  /**
+   * Set data direction to output; write to device.
+   */
+  void output()
+    __attribute__((always_inline))
+  {
+    m_sda.output();
+  }
+
+  /**
+   * Low level read data from the device. Internal transfer
+   * function. Used within a chip select block. Data direction must be
+   * set before calling this function.
+   * @return data read from the device.
+   */
+  uint8_t read()
+  {
+    uint8_t res = read_bit(0x01);
+    res |= read_bit(0x02);
+    res |= read_bit(0x04);
+    res |= read_bit(0x08);
+    res |= read_bit(0x10);
+    res |= read_bit(0x20);
+    res |= read_bit(0x40);
+    res |= read_bit(0x80);
+    return (res);
+  }
+
+  /**
+   * Write low level data to the device. Internal transfer
+   * function. Used within a chip select block.
+   * @param[in] data to write to the device.
+   */
+  void write(uint8_t data)
+  {
+    write_bit(data & 0x01);
+    write_bit(data & 0x02);
+    write_bit(data & 0x04);
+    write_bit(data & 0x08);
+    write_bit(data & 0x10);
+    write_bit(data & 0x20);
+    write_bit(data & 0x40);
+    write_bit(data & 0x80);
+  }
+
+protected:
+  GPIO<CS_PIN> m_cs;		//!< Chip select, asserted high.
+  GPIO<SDA_PIN> m_sda;		//!< Serial data, bidirectional.
+  GPIO<CLK_PIN> m_clk;		//!< Clock for synchronized data.
+
+  /** Clock high time (cycles, rounded up). */
+  static const uint16_t CH =
+    ((uint64_t) T_CH * F_CPU + 999999999ULL) / 1000000000ULL;
+
+  /** Clock low time (cycles, rounded up). */
+  static const uint16_t CL =
+    ((uint64_t) T_CL * F_CPU + 999999999ULL) / 1000000000ULL;
+
+  /** Chip select to clock setup time (cycles, rounded up). */
+  static const uint16_t CC =
+    ((uint64_t) T_CC * F_CPU + 999999999ULL) / 1000000000ULL;
+
+  /** Clock high delay (cycles); less clock toggle. */
+  static const uint16_t CH_CYCLES = (CH > 1 ? CH - 1 : 0);
+
+  /** Clock low delay (cycles); less data access and clock toggle. */
+  static const uint16_t CL_CYCLES = (CL > 2 ? CL - 2 : 0);
+
+  /** Chip select delay (cycles); less chip select toggle. */
+  static const uint16_t CC_CYCLES = (CC > 1 ? CC - 1 : 0);
+
+  /**
+   * Delay given number of clock cycles.
+   * @param[in] CYCLES number of clock cycles.
+   */
+  template<uint16_t CYCLES>
+  static void delay()
+  {
+#if defined(AVR)
+    __builtin_avr_delay_cycles(CYCLES);
+#else
+    for (uint16_t i = 0; i < CYCLES; i++) __asm__ __volatile__("nop");
+#endif
+  }
+
+  /**
+   * Read bit from the device. The bit is sampled after the clock low
+   * time; the device shifts the next bit on the falling clock edge.
+   * @param[in] mask bit mask.
+   * @return mask if bit set otherwise zero.
+   */
+  uint8_t read_bit(uint8_t mask)
+    __attribute__((always_inline))
+  {
+    delay<CL_CYCLES>();
+    uint8_t res = (m_sda ? mask : 0x00);
+    m_clk.toggle();
+    delay<CH_CYCLES>();
+    m_clk.toggle();
+    return (res);
+  }
+
+  /**
+   * Write bit to the device. The bit is latched on the rising clock
+   * edge after the clock low time.
+   * @param[in] bit value.
+   */
+  void write_bit(bool bit)
+    __attribute__((always_inline))
+  {
+    m_sda = bit;
+    delay<CL_CYCLES>();
+    m_clk.toggle();
+    delay<CH_CYCLES>();
+    m_clk.toggle();
+  }
+};
+
+#if defined(SPCR)
+/**
+ * Hardware SPI based transport for the DS1302 driver. The SPI is
+ * used in mode 0 with least significant bit first. The DS1302 data
+ * line is connected to both MISO and MOSI, and MOSI is set to input
+ * mode while reading. The SPI is configured on each select so that
+ * the bus may be shared with other SPI devices. The SS pin is set to
+ * output mode (master).
+ * @param[in] CS_PIN chip select board pin.
+ * @param[in] MOSI_PIN SPI MOSI board pin (default D11).
+ * @param[in] FREQ max SPI clock frequency (Hz, default 2 MHz at 5 V,
+ *   use 500 kHz at 2 V).
+ * @param[in] T_CC minimum chip select to clock setup time (ns,
+ *   default 4000 at 2 V, use 1000 at 5 V).
+ *
+ * @section Circuit
+ * @code
+ *                         DS1302/RTC
+ *                       +------------+
+ * (VCC)---------------1-|VCC         |
+ * (GND)---------------2-|GND         |
+ * (SCK/D13)-----------3-|CLK         |
+ * (MISO/D12)------+---4-|DAT         |
+ * (MOSI/D11)-[1K]-+     |            |
+ * (CS)----------------5-|RST         |
+ *                       +------------+
+ * @endcode
+ */
+template<BOARD::pin_t CS_PIN, BOARD::pin_t MOSI_PIN = BOARD::D11,
+	 uint32_t FREQ = 2000000UL, uint16_t T_CC = 4000>
+class DS1302SPI {
+public:
+  /**
+   * Construct transport with the given chip select pin. Initiate
+   * pins (output mode).
+   */
+  DS1302SPI()
+  {
+    pinMode(SS, OUTPUT);
+    pinMode(SCK, OUTPUT);
+    m_cs.output();
+    m_cs.low();
+    m_mosi.output();
+  }
+
+  /**
+   * Configure SPI and assert chip select; start of transfer block.
+   * Waits for chip select to clock setup time.
+   */
+  void select()
+    __attribute__((always_inline))
+  {
+    SPCR = _BV(SPE) | _BV(MSTR) | _BV(DORD) | SPR;
+    SPSR = SPI2X_MASK;
+    m_cs.high();
+    __builtin_avr_delay_cycles(CC_CYCLES);
+  }
+
+  /**
+   * Deassert chip select; end of transfer block.
+   */
+  void deselect()
+    __attribute__((always_inline))
+  {
+    m_cs.low();
+  }
+
+  /**
+   * Set MOSI to input mode; read from device.
+   */
+  void input()
+    __attribute__((always_inline))
+  {
+    m_mosi.input();
+  }
+
+  /**
+   * Set MOSI to output mode; write to device.
+   */
+  void output()
+    __attribute__((always_inline))
+  {
+    m_mosi.output();
+  }
+
+  /**
+   * Read data from the device. Used within a chip select block.
+   * @return data read from the device.
+   */
+  uint8_t read()
+  {
+    SPDR = 0;
+    while ((SPSR & _BV(SPIF)) == 0);
+    return (SPDR);
+  }
+
+  /**
+   * Write data to the device. Used within a chip select block.
+   * @param[in] data to write to the device.
+   */
+  void write(uint8_t data)
+  {
+    SPDR = data;
+    while ((SPSR & _BV(SPIF)) == 0);
+  }
+
+protected:
+  /** SPI clock divider index; divider 2 << DIV. */
+  static const uint8_t DIV =
+    (F_CPU / 2 <= FREQ) ? 0 :
+    (F_CPU / 4 <= FREQ) ? 1 :
+    (F_CPU / 8 <= FREQ) ? 2 :
+    (F_CPU / 16 <= FREQ) ? 3 :
+    (F_CPU / 32 <= FREQ) ? 4 :
+    (F_CPU / 64 <= FREQ) ? 5 : 6;
+
+  /** SPI clock rate select bits (SPCR). */
+  static const uint8_t SPR = (DIV < 6 ? (DIV >> 1) : 3);
+
+  /** SPI double speed bit (SPSR). */
+  static const uint8_t SPI2X_MASK = (DIV < 6 && !(DIV & 1) ? _BV(SPI2X) : 0);
+
+  /** Chip select to clock setup time (cycles, rounded up). */
+  static const uint16_t CC =
+    ((uint64_t) T_CC * F_CPU + 999999999ULL) / 1000000000ULL;
+
+  /** Chip select delay (cycles); less chip select toggle. */
+  static const uint16_t CC_CYCLES = (CC > 1 ? CC - 1 : 0);
+
+  GPIO<CS_PIN> m_cs;		//!< Chip select, asserted high.
+  GPIO<MOSI_PIN> m_mosi;	//!< Serial data output.
+};
+#endif
+
+/**
+ * Device driver for DS1302, Trickle-Charge Timekeeping Chip. The
+ * transfer of bytes on the 3-wire interface is delegated to the
+ * given transport; DS1302GPIO (software) or DS1302SPI (hardware).
+ * The transport should implement select(), deselect(), input(),
+ * output(), read() and write().
+ * @param[in] TRANSPORT device transport class.
  *
  * @section Circuit
  * @code
@@ -49,79 +364,93 @@
  * http://www.maximintegrated.com/datasheet/index.mvp/id/2685
  * 2. Datasheet, http://datasheets.maximintegrated.com/en/ds/DS1302.pdf
  */
-template<BOARD::pin_t CS_PIN, BOARD::pin_t SDA_PIN, BOARD::pin_t CLK_PIN>
-class DS1302 {
+template<typename TRANSPORT>
+class DS1302Driver {
 public:
+  /** Start of static memory; address of read_ram() and write_ram(). */
+  static const uint8_t RAM_START = 0;
+
   /** Static memory size. */
   static const size_t RAM_MAX = 31;
 
+  /** Block transfer from address zero is a single burst. */
+  static const bool RAM_BURST_ZERO = true;
+
   /**
-   * Construct device driver for DS1302 Real-Time Clock with the given
-   * pins. Initiate pins (output mode).
+   * Construct device driver for DS1302 Real-Time Clock with the
+   * given transport.
    */
-  DS1302()
-  {
-    m_cs.output();
-    m_cs.low();
-    m_sda.output();
-    m_clk.output();
-    m_clk.low();
-  }
+  DS1302Driver() {}
 
   /**
    * Read clock and calender from the device. Return in standard
-   * time structure.
+   * time structure. Return true(1) if successful otherwise false(0);
+   * clock halted or registers with invalid values.
    * @param[in,out] now time structure for return value.
+   * @return bool.
    */
-  void get_time(struct tm& now)
+  bool get_time(struct tm& now)
   {
     // Burst read clock and calender from device
     rtc_t rtc;
-    m_cs.high();
-    write(RTC_BURST | READ);
-    m_sda.input();
+    m_bus.select();
+    m_bus.write(RTC_BURST | READ);
+    m_bus.input();
     uint8_t* rp = (uint8_t*) &rtc;
     for (size_t i = 0; i < sizeof(rtc); i++, rp++)
-      *rp = read();
-    m_sda.output();
-    m_cs.low();
+      *rp = m_bus.read();
+    m_bus.output();
+    m_bus.deselect();
 
     // Convert to standard time structure
-    now.tm_sec = rtc.seconds;
-    now.tm_min = rtc.minutes;
-    now.tm_hour = rtc.hours;
-    now.tm_mday = rtc.date;
-    now.tm_wday = rtc.day - 1;
-    now.tm_mon = rtc.month - 1;
-    now.tm_year = rtc.year + 100;
+    if (*((uint8_t*) &rtc.seconds) & CLOCK_HALT) return (false);
+    uint8_t reg[RTC_REGS];
+    if (bcd_t::decode(reg, &rtc.seconds, RTC_REGS)) return (false);
+    if (reg[0] > 59 || reg[1] > 59 || reg[2] > 23
+	|| reg[3] < 1 || reg[3] > 31 || reg[4] < 1 || reg[4] > 12
+	|| reg[5] < 1 || reg[5] > 7 || reg[6] > 99)
+      return (false);
+    now.tm_sec = reg[0];
+    now.tm_min = reg[1];
+    now.tm_hour = reg[2];
+    now.tm_mday = reg[3];
+    now.tm_mon = reg[4] - 1;
+    now.tm_wday = reg[5] - 1;
+    now.tm_year = reg[6] + 100;
+    return (true);
   }
 
   /**
    * Write clock and calender in given standard time structure to the
-   * device.
+   * device. Return true(1), as the DS1307 driver.
    * @param[in] now time to set.
+   * @return bool.
    */
-  void set_time(struct tm& now)
+  bool set_time(struct tm& now)
   {
     // Convert from standard time structure, and add write disable
     rtc_t rtc;
-    rtc.seconds = now.tm_sec;
-    rtc.minutes = now.tm_min;
-    rtc.hours = now.tm_hour;
-    rtc.date = now.tm_mday;
-    rtc.day = now.tm_wday + 1;
-    rtc.month = now.tm_mon + 1;
-    rtc.year = now.tm_year - 100;
+    uint8_t reg[RTC_REGS] = {
+      (uint8_t) now.tm_sec,
+      (uint8_t) now.tm_min,
+      (uint8_t) now.tm_hour,
+      (uint8_t) now.tm_mday,
+      (uint8_t) (now.tm_mon + 1),
+      (uint8_t) (now.tm_wday + 1),
+      (uint8_t) (now.tm_year - 100)
+    };
+    bcd_t::encode(&rtc.seconds, reg, RTC_REGS);
     rtc.wp = 0x80;
 
     // Burst write clock and calender to device
     write_enable();
-    m_cs.high();
-    write(RTC_BURST | WRITE);
+    m_bus.select();
+    m_bus.write(RTC_BURST | WRITE);
     uint8_t* rp = (uint8_t*) &rtc;
     for (size_t i = 0; i < sizeof(rtc); i++, rp++)
-      write(*rp);
-    m_cs.low();
+      m_bus.write(*rp);
+    m_bus.deselect();
+    return (true);
   }
 
   /**
@@ -149,7 +478,7 @@ public:
   uint8_t read_ram(uint8_t addr)
     __attribute__((always_inline))
   {
-    return (read(RAM_START | (addr & ADDR_MASK)));
+    return (read(RAM_REG | (addr & ADDR_MASK)));
   }
 
   /**
@@ -161,7 +490,7 @@ public:
   void write_ram(uint8_t addr, uint8_t data)
     __attribute__((always_inline))
   {
-    write(RAM_START | (addr & ADDR_MASK), data);
+    write(RAM_REG | (addr & ADDR_MASK), data);
   }
 
   /**
@@ -175,12 +504,12 @@ public:
     if (size == 0) return;
     uint8_t* bp = (uint8_t*) buf;
     if (size > RAM_MAX) size = RAM_MAX;
-    m_cs.high();
-    write(RAM_BURST | READ);
-    m_sda.input();
-    do *bp++ = read(); while (--size);
-    m_sda.output();
-    m_cs.low();
+    m_bus.select();
+    m_bus.write(RAM_BURST | READ);
+    m_bus.input();
+    do *bp++ = m_bus.read(); while (--size);
+    m_bus.output();
+    m_bus.deselect();
   }
 
   /**
@@ -196,16 +525,63 @@ public:
     uint8_t* bp = (uint8_t*) buf;
     if (size > RAM_MAX) size = RAM_MAX;
     write_enable();
-    m_cs.high();
-    write(RAM_BURST | WRITE);
-    do write(*bp++); while (--size);
-    m_cs.low();
+    m_bus.select();
+    m_bus.write(RAM_BURST | WRITE);
+    do m_bus.write(*bp++); while (--size);
+    m_bus.deselect();
+    write_disable();
+  }
+
+  /**
+   * Read memory block with the given size from the given static
+   * memory address into the buffer. A block from address zero is
+   * read with a burst transfer. Return true(1) if successful
+   * otherwise false(0); block outside static memory.
+   * @param[in] addr memory address on the device (0..RAM_MAX-1).
+   * @param[in] buf buffer to store data read.
+   * @param[in] count number of bytes to read.
+   * @return bool.
+   */
+  bool read_ram(uint8_t addr, void* buf, size_t count)
+  {
+    if (addr + count > RAM_MAX) return (false);
+    if (addr == 0) {
+      read_ram(buf, count);
+      return (true);
+    }
+    uint8_t* bp = (uint8_t*) buf;
+    while (count--) *bp++ = read_ram(addr++);
+    return (true);
+  }
+
+  /**
+   * Write memory block with the given size to the given static
+   * memory address. A block from address zero is written with a
+   * burst transfer. Includes handling of write protect. Return
+   * true(1) if successful otherwise false(0); block outside static
+   * memory.
+   * @param[in] addr memory address on the device (0..RAM_MAX-1).
+   * @param[in] buf buffer with data to write.
+   * @param[in] count number of bytes to write.
+   * @return bool.
+   */
+  bool write_ram(uint8_t addr, const void* buf, size_t count)
+  {
+    if (addr + count > RAM_MAX) return (false);
+    if (addr == 0) {
+      write_ram((void*) buf, count);
+      return (true);
+    }
+    const uint8_t* bp = (const uint8_t*) buf;
+    write_enable();
+    while (count--) write_ram(addr++, *bp++);
     write_disable();
+    return (true);
   }
 
 protected:
-  /** Start address of static memory. */
-  static const uint8_t RAM_START = 32;
+  /** Register address of static memory. */
+  static const uint8_t RAM_REG = 32;
 
   /** Write protect register. */
   static const uint8_t WP = 0x07;
@@ -233,9 +609,14 @@ protected:
     uint8_t wp;			//!< Write protect register.
   } __attribute__((packed));
 
-  GPIO<CS_PIN> m_cs;		//!< Chip select, asserted high.
-  GPIO<SDA_PIN> m_sda;		//!< Serial data, bidirectional.
-  GPIO<CLK_PIN> m_clk;		//!< Clock for synchronized data.
+  /** Number of clock/calender registers (BCD). */
+  static const uint8_t RTC_REGS = 7;
+
+  /** Clock halt flag in seconds register. */
+  static const uint8_t CLOCK_HALT = 0x80;
+
+  /** Device transport. */
+  TRANSPORT m_bus;
 
   /**
    * Low level RTC access function. Read data from the clock/calender
@@ -247,12 +628,12 @@ protected:
   {
     addr = ((addr << 1) | READ);
     uint8_t res = 0;
-    m_cs.high();
-    write(addr);
-    m_sda.input();
-    res = read();
-    m_sda.output();
-    m_cs.low();
+    m_bus.select();
+    m_bus.write(addr);
+    m_bus.input();
+    res = m_bus.read();
+    m_bus.output();
+    m_bus.deselect();
     return (res);
   }
 
@@ -265,50 +646,29 @@ protected:
   void write(uint8_t addr, uint8_t data)
   {
     addr = ((addr << 1) | WRITE);
-    m_cs.high();
-    write(addr);
-    write(data);
-    m_cs.low();
-  }
-
-  /**
-   * Low level read data from the device. Internal transfer
-   * function. Used within a chip select block. Data direction must be
-   * set before calling this function.
-   * @return data read from the device.
-   */
-  uint8_t read()
-  {
-    uint8_t mask = 0x01;
-    uint8_t res = 0;
-    do {
-      res |= (m_sda ? mask : 0x00);
-      m_clk.toggle();
-      __asm__ __volatile__("nop");
-      mask <<= 1;
-      m_clk.toggle();
-      __asm__ __volatile__("nop");
-    } while (mask);
-    return (res);
+    m_bus.select();
+    m_bus.write(addr);
+    m_bus.write(data);
+    m_bus.deselect();
   }
+};
 
-  /**
-   * Write low level data to the device. Internal transfer
-   * function. Used within a chip select block.
-   * @param[in] data to write to the device.
-   */
-  void write(uint8_t data)
-  {
-    uint8_t mask = 0x01;
-    do {
-      m_sda = data & mask;
-      __asm__ __volatile__("nop");
-      m_clk.toggle();
-      __asm__ __volatile__("nop");
-      mask <<= 1;
-      m_clk.toggle();
-    } while (mask);
-  }
+/**
+ * GPIO based device driver for DS1302, Trickle-Charge Timekeeping
+ * Chip. See DS1302Driver and DS1302GPIO.
+ * @param[in] CS_PIN chip select board pin.
+ * @param[in] SDA_PIN serial data board pin.
+ * @param[in] CLK_PIN clock board pin.
+ * @param[in] T_CH minimum clock high time (ns, default 250).
+ * @param[in] T_CL minimum clock low time (ns, default 250).
+ * @param[in] T_CC minimum chip select to clock setup time (ns,
+ *   default 1000).
+ */
+template<BOARD::pin_t CS_PIN, BOARD::pin_t SDA_PIN, BOARD::pin_t CLK_PIN,
+	 uint16_t T_CH = 250, uint16_t T_CL = 250, uint16_t T_CC = 1000>
+class DS1302 :
+  public DS1302Driver<DS1302GPIO<CS_PIN, SDA_PIN, CLK_PIN,
+				 T_CH, T_CL, T_CC> > {
 };
 
 #endif
@@ -22,6 +22,11 @@
 #include "RTC.h"
 #include "TWI.h"
 
+#if defined(TWCR)
+#include "Hardware/TWI.h"
+#include <util/twi.h>
+#endif
+
 /**
  * Driver for the DS1307, 64 X 8, Serial I2C Real-Time Clock,
  * a low-power, full binary-coded decimal (BCD) clock/calendar plus
@@ -49,11 +54,32 @@ public:
   /**
    * Construct DS1307 device driver with bus address(0x68).
    */
-  DS1307(TWI& twi) : TWI::Device(twi, 0x68) {}
+  DS1307(TWI& twi) :
+    TWI::Device(twi, 0x68)
+#if defined(TWCR)
+    , m_state(IDLE),
+    m_hardware(false),
+    m_callback(NULL)
+#endif
+  {}
+
+#if defined(TWCR)
+  /**
+   * Construct DS1307 device driver with bus address(0x68) on the
+   * hardware TWI bus manager; enables asynchronous read.
+   */
+  DS1307(Hardware::TWI& twi) :
+    TWI::Device(twi, 0x68),
+    m_state(IDLE),
+    m_hardware(true),
+    m_callback(NULL)
+  {}
+#endif
 
   /**
    * Read current time from real-time clock. Return true(1)
-   * if successful otherwise false(0).
+   * if successful otherwise false(0); bus error, clock halted or
+   * registers with invalid values.
    * @param[out] now time structure return value.
    * @return boolean.
    */
@@ -64,14 +90,7 @@ public:
     if (!read_ram(0, &rtc, sizeof(rtc))) return (false);
 
     // Convert to time structure
-    now.tm_sec = rtc.seconds;
-    now.tm_min = rtc.minutes;
-    now.tm_hour = rtc.hours;
-    now.tm_mday = rtc.date;
-    now.tm_wday = rtc.day - 1;
-    now.tm_mon = rtc.month - 1;
-    now.tm_year = rtc.year + 100;
-    return (true);
+    return (decode(now, rtc));
   }
 
   /**
@@ -84,13 +103,16 @@ public:
   {
     // Convert from time structure
     rtc_t rtc;
-    rtc.seconds = now.tm_sec;
-    rtc.minutes = now.tm_min;
-    rtc.hours = now.tm_hour;
-    rtc.date = now.tm_mday;
-    rtc.day = now.tm_wday + 1;
-    rtc.month = now.tm_mon + 1;
-    rtc.year = now.tm_year - 100;
+    uint8_t reg[sizeof(rtc)] = {
+      (uint8_t) now.tm_sec,
+      (uint8_t) now.tm_min,
+      (uint8_t) now.tm_hour,
+      (uint8_t) (now.tm_wday + 1),
+      (uint8_t) now.tm_mday,
+      (uint8_t) (now.tm_mon + 1),
+      (uint8_t) (now.tm_year - 100)
+    };
+    bcd_t::encode(&rtc.seconds, reg, sizeof(rtc));
 
     // Write clock/calender structure to device
     return (write_ram(0, &rtc, sizeof(rtc)));
@@ -144,6 +166,10 @@ public:
 
   /** Max size of application RAM (56 bytes). */
   const static uint8_t RAM_MAX = RAM_END - RAM_START + 1;
+
+  /** Block transfer from any address is a single transaction. */
+  const static bool RAM_BURST_ZERO = false;
+
   /**
    * Read ram block with the given size into the buffer. Return
    * true(1) if successful otherwise false.
@@ -155,8 +181,8 @@ public:
   bool read_ram(uint8_t addr, void* buf, size_t count)
   {
     if (!acquire()) return (false);
-    if (write(&addr, sizeof(addr)) != sizeof(addr)) return (false);
-    bool res = (read(buf, count) == (int) count);
+    bool res = (write(&addr, sizeof(addr)) == sizeof(addr))
+      && (read(buf, count) == (int) count);
     if (!release()) return (false);
     return (res);
   }
@@ -183,7 +209,126 @@ public:
     return (res);
   }
 
+#if defined(TWCR)
+  /**
+   * Completion callback for asynchronous read; called from poll()
+   * with the device and the result status.
+   */
+  typedef void (*callback_t)(DS1307* rtc, bool status);
+
+  /**
+   * Start asynchronous read of the clock/calendar registers. The
+   * transfer is performed with the AVR hardware TWI, and advanced by
+   * calling poll() from the main loop; one bus step per call. The bus
+   * is acquired until the transfer is completed; other devices on
+   * the bus should not be accessed until then. The bit rate is kept
+   * unless faster than the device allows. Requires the driver to be
+   * constructed with the hardware TWI bus manager. Return true(1) if
+   * started otherwise false(0).
+   * @param[in] callback on completion (default none).
+   * @return bool.
+   */
+  bool get_time_async(callback_t callback = NULL)
+  {
+    if (!m_hardware) return (false);
+    if (m_state != IDLE && m_state != COMPLETED && m_state != FAILED)
+      return (false);
+    if (!acquire()) return (false);
+    m_callback = callback;
+    m_count = 0;
+    m_twbr = TWBR;
+    m_twsr = TWSR;
+
+    // Bit rate divisor; 16 + 2 * TWBR * 4^TWPS
+    uint32_t div = 16 + ((uint32_t) m_twbr << (1 + 2 * (m_twsr & 0x03)));
+    if (div < F_CPU / FREQ) {
+      TWSR = 0;
+      TWBR = ((F_CPU / FREQ) - 16) / 2;
+    }
+    m_state = START;
+    TWCR = _BV(TWINT) | _BV(TWSTA) | _BV(TWEN);
+    return (true);
+  }
+
+  /**
+   * Advance the asynchronous read. Should be called until the
+   * transfer has completed. Return one(1) when completed, zero(0)
+   * while in progress, and negative(-1) on bus error or if no
+   * transfer was started.
+   * @return status.
+   */
+  int8_t poll()
+  {
+    if (m_state == COMPLETED) return (1);
+    if (m_state == IDLE || m_state == FAILED) return (-1);
+    if ((TWCR & _BV(TWINT)) == 0) return (0);
+    uint8_t status = TWSR & 0xf8;
+    switch (m_state) {
+    case START:
+      if (status != TW_START && status != TW_REP_START) break;
+      TWDR = ADDR << 1;
+      TWCR = _BV(TWINT) | _BV(TWEN);
+      m_state = ADDRESS_WRITE;
+      return (0);
+    case ADDRESS_WRITE:
+      if (status != TW_MT_SLA_ACK) break;
+      TWDR = 0;
+      TWCR = _BV(TWINT) | _BV(TWEN);
+      m_state = REGISTER;
+      return (0);
+    case REGISTER:
+      if (status != TW_MT_DATA_ACK) break;
+      TWCR = _BV(TWINT) | _BV(TWSTA) | _BV(TWEN);
+      m_state = RESTART;
+      return (0);
+    case RESTART:
+      if (status != TW_REP_START) break;
+      TWDR = (ADDR << 1) | 1;
+      TWCR = _BV(TWINT) | _BV(TWEN);
+      m_state = ADDRESS_READ;
+      return (0);
+    case ADDRESS_READ:
+      if (status != TW_MR_SLA_ACK) break;
+      TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWEA);
+      m_state = DATA;
+      return (0);
+    case DATA:
+      if (status != TW_MR_DATA_ACK && status != TW_MR_DATA_NACK) break;
+      ((uint8_t*) &m_rtc)[m_count++] = TWDR;
+      if (m_count < sizeof(m_rtc)) {
+	if (m_count < sizeof(m_rtc) - 1)
+	  TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWEA);
+	else
+	  TWCR = _BV(TWINT) | _BV(TWEN);
+	return (0);
+      }
+      complete(COMPLETED);
+      return (1);
+    default:
+      break;
+    }
+    complete(FAILED);
+    return (-1);
+  }
+
+  /**
+   * Return the time of a completed asynchronous read. Return true(1)
+   * if successful otherwise false(0); transfer not completed, clock
+   * halted or registers with invalid values.
+   * @param[out] now time structure return value.
+   * @return bool.
+   */
+  bool get_time_result(struct tm& now)
+  {
+    if (m_state != COMPLETED) return (false);
+    return (decode(now, m_rtc));
+  }
+#endif
+
 protected:
+  /** Max bus frequency (Hz). */
+  static const uint32_t FREQ = 100000UL;
+
   /**
    * The Timekeeper Clock/Calender Registers (Table 2, pp. 8).
    */
@@ -231,5 +376,78 @@ protected:
     control_t control;		//!< Control Register.
     uint8_t ram[RAM_MAX];	//!< Random Access Memory.
   } __attribute__((packed));
+
+  /** Clock halt flag in seconds register. */
+  static const uint8_t CLOCK_HALT = 0x80;
+
+  /**
+   * Convert the given clock/calendar registers to time structure.
+   * Return true(1) if successful otherwise false(0); clock halted or
+   * registers with invalid values.
+   * @param[out] now time structure return value.
+   * @param[in] rtc clock/calendar registers.
+   * @return bool.
+   */
+  static bool decode(struct tm& now, const rtc_t& rtc)
+  {
+    if (*((const uint8_t*) &rtc.seconds) & CLOCK_HALT) return (false);
+    uint8_t reg[sizeof(rtc)];
+    if (bcd_t::decode(reg, &rtc.seconds, sizeof(rtc))) return (false);
+    if (reg[0] > 59 || reg[1] > 59 || reg[2] > 23
+	|| reg[3] < 1 || reg[3] > 7 || reg[4] < 1 || reg[4] > 31
+	|| reg[5] < 1 || reg[5] > 12 || reg[6] > 99)
+      return (false);
+    now.tm_sec = reg[0];
+    now.tm_min = reg[1];
+    now.tm_hour = reg[2];
+    now.tm_wday = reg[3] - 1;
+    now.tm_mday = reg[4];
+    now.tm_mon = reg[5] - 1;
+    now.tm_year = reg[6] + 100;
+    return (true);
+  }
+
+#if defined(TWCR)
+  /** Device bus address. */
+  static const uint8_t ADDR = 0x68;
+
+  /** Asynchronous read states. */
+  enum {
+    IDLE,			//!< No transfer started.
+    START,			//!< Start condition sent.
+    ADDRESS_WRITE,		//!< Address and write sent.
+    REGISTER,			//!< Register address sent.
+    RESTART,			//!< Repeated start condition sent.
+    ADDRESS_READ,		//!< Address and read sent.
+    DATA,			//!< Receiving registers.
+    COMPLETED,			//!< Transfer completed.
+    FAILED			//!< Bus error.
+  };
+
+  uint8_t m_state;		//!< Asynchronous read state.
+  bool m_hardware;		//!< Hardware TWI bus manager.
+  uint8_t m_count;		//!< Number of received registers.
+  uint8_t m_twbr;		//!< Saved bit rate register.
+  uint8_t m_twsr;		//!< Saved status register (prescaler).
+  rtc_t m_rtc;			//!< Received registers.
+  callback_t m_callback;	//!< Completion callback.
+
+  /**
+   * Complete asynchronous read with the given state; issue stop
+   * condition, restore bus bit rate, release the bus and call the
+   * completion callback.
+   * @param[in] state COMPLETED or FAILED.
+   */
+  void complete(uint8_t state)
+  {
+    TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWSTO);
+    while (TWCR & _BV(TWSTO));
+    TWBR = m_twbr;
+    TWSR = m_twsr;
+    m_state = state;
+    release();
+    if (m_callback != NULL) m_callback(this, state == COMPLETED);
+  }
+#endif
 };
 #endif
@@ -0,0 +1,209 @@
+/**
+ * @file Hardware/AVR/Calendar.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef HARDWARE_AVR_CALENDAR_H
+#define HARDWARE_AVR_CALENDAR_H
+
+/**
+ * Incremental time conversion. The calendar remembers the latest
+ * converted time stamp and the broken-down time. A time stamp less
+ * than a day ahead is converted by updating the time structure field
+ * by field. Other time stamps are converted with gmtime_r().
+ */
+class Calendar {
+public:
+  /**
+   * Construct calendar at epoch.
+   */
+  Calendar() :
+    m_time(0)
+  {
+    ::gmtime_r(&m_time, &m_now);
+  }
+
+  /**
+   * Convert the time stamp pointed to by timer into broken-down
+   * time, expressed as UTC. See gmtime_r().
+   * @param[in] timer time stamp to convert.
+   * @param[out] timeptr time structure for return value.
+   * @return time structure pointer.
+   */
+  struct tm* gmtime_r(const time_t* timer, struct tm* timeptr)
+  {
+    set(*timer);
+    *timeptr = m_now;
+    return (timeptr);
+  }
+
+  /**
+   * Convert the time stamp pointed to by timer into broken-down
+   * time, expressed as Local time. See localtime_r().
+   * @param[in] timer time stamp to convert.
+   * @param[out] timeptr time structure for return value.
+   * @return time structure pointer.
+   */
+  struct tm* localtime_r(const time_t* timer, struct tm* timeptr)
+  {
+    zone_t zone;
+    get_zone(&zone);
+    return (localtime_r(timer, timeptr, zone));
+  }
+
+  /**
+   * Convert the time stamp pointed to by timer into broken-down
+   * time, expressed as local time in the given time zone.
+   * See localtime_z().
+   * @param[in] timer time stamp to convert.
+   * @param[out] timeptr time structure for return value.
+   * @param[in] zone time zone.
+   * @return time structure pointer.
+   */
+  struct tm* localtime_r(const time_t* timer, struct tm* timeptr,
+			 zone_t& zone)
+  {
+    int16_t dst = zone_dst(timer, &zone);
+    time_t lt = *timer + zone.offset;
+    if (dst > 0) lt += dst;
+    gmtime_r(&lt, timeptr);
+    timeptr->tm_isdst = dst;
+    return (timeptr);
+  }
+
+  /**
+   * Set the calendar to the given time stamp. Incremental update if
+   * the time stamp is less than a day ahead of the current,
+   * otherwise full conversion.
+   * @param[in] time stamp.
+   */
+  void set(time_t time)
+  {
+    if (time >= m_time && time - m_time < (time_t) ONE_DAY) {
+      add(time - m_time);
+      return;
+    }
+    m_time = time;
+    ::gmtime_r(&m_time, &m_now);
+  }
+
+  /**
+   * Advance the calendar with the given number of seconds. The
+   * number of seconds must be less than a day.
+   * @param[in] seconds to add.
+   */
+  void add(uint32_t seconds)
+  {
+    m_time += seconds;
+
+    // Common case; within the current minute
+    if (seconds < 60) {
+      uint8_t sec = m_now.tm_sec + seconds;
+      if (sec < 60) {
+	m_now.tm_sec = sec;
+	return;
+      }
+      m_now.tm_sec = sec - 60;
+      if (m_now.tm_min < 59) {
+	m_now.tm_min += 1;
+	return;
+      }
+      m_now.tm_min = 0;
+      if (m_now.tm_hour < 23) {
+	m_now.tm_hour += 1;
+	return;
+      }
+      m_now.tm_hour = 0;
+      next_day();
+      return;
+    }
+
+    // Break down the new time of day, and roll over to the next day
+    uint32_t tod = m_now.tm_hour * 3600UL
+      + m_now.tm_min * 60U
+      + m_now.tm_sec
+      + seconds;
+    if (tod >= ONE_DAY) {
+      tod -= ONE_DAY;
+      next_day();
+    }
+    uint16_t rem = tod % 3600U;
+    m_now.tm_hour = tod / 3600U;
+    m_now.tm_min = rem / 60;
+    m_now.tm_sec = rem % 60;
+  }
+
+  /**
+   * Return the current time stamp of the calendar.
+   * @return time stamp.
+   */
+  time_t time() const
+  {
+    return (m_time);
+  }
+
+  /**
+   * Return the current broken-down time of the calendar.
+   * @return time structure.
+   */
+  const struct tm& now() const
+  {
+    return (m_now);
+  }
+
+protected:
+  /** Latest converted time stamp. */
+  time_t m_time;
+
+  /** Broken-down time of latest converted time stamp. */
+  struct tm m_now;
+
+  /**
+   * Advance day of week, year and month to the next day.
+   */
+  void next_day()
+  {
+    m_now.tm_wday = (m_now.tm_wday == SATURDAY ? SUNDAY : m_now.tm_wday + 1);
+    m_now.tm_yday += 1;
+    if (m_now.tm_mday < days_in_month()) {
+      m_now.tm_mday += 1;
+      return;
+    }
+    m_now.tm_mday = 1;
+    if (m_now.tm_mon < DECEMBER) {
+      m_now.tm_mon += 1;
+      return;
+    }
+    m_now.tm_mon = JANUARY;
+    m_now.tm_year += 1;
+    m_now.tm_yday = 0;
+  }
+
+  /**
+   * Return number of days in the current month. The months alternate
+   * between 31 and 30 days with a phase change in August.
+   * @return days.
+   */
+  uint8_t days_in_month() const
+  {
+    uint8_t mon = m_now.tm_mon + 1;
+    if (m_now.tm_mon == FEBRUARY)
+      return (28 + is_leap_year(m_now.tm_year + 1900));
+    return (30 + ((mon + (mon >> 3)) & 1));
+  }
+};
+
+#endif
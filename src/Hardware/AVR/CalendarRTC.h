@@ -0,0 +1,144 @@
+/**
+ * @file Hardware/AVR/CalendarRTC.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef HARDWARE_AVR_CALENDAR_RTC_H
+#define HARDWARE_AVR_CALENDAR_RTC_H
+
+/**
+ * Software Real-Time Clock with calendar. The broken-down time is
+ * advanced field by field on each tick so that reading the time
+ * structure is a copy.
+ */
+class CalendarRTC : public RTC {
+public:
+  /**
+   * Construct software real-time clock with calendar based on
+   * millis().
+   */
+  CalendarRTC() :
+    RTC()
+  {}
+
+  using RTC::get_time;
+  using RTC::set_time;
+
+  /**
+   * Increment seconds counter and calendar when time has elapsed.
+   * Return true(1) if an increment occured, otherwise false(0).
+   */
+  bool tick()
+  {
+    uint16_t now = millis();
+    uint16_t length;
+    if (elapsed(now - m_millis, length, 1) == 0) return (false);
+    uint8_t sreg = SREG;
+    __asm__ __volatile__("cli" ::: "memory");
+    m_time += 1;
+    m_millis = now;
+    m_calendar.add(1);
+    SREG = sreg;
+    __asm__ __volatile__("" ::: "memory");
+    return (true);
+  }
+
+  /**
+   * Increment seconds counter and calendar with the number of whole
+   * seconds elapsed since the previous update. The remaining
+   * milliseconds are carried forward. Return number of seconds
+   * applied.
+   * @return seconds.
+   */
+  uint16_t update()
+  {
+    uint16_t now = millis();
+    uint16_t length;
+    uint16_t seconds = elapsed(now - m_millis, length, UINT16_MAX);
+    if (seconds == 0) return (0);
+    uint8_t sreg = SREG;
+    __asm__ __volatile__("cli" ::: "memory");
+    m_time += seconds;
+    m_millis += length;
+    m_calendar.add(seconds);
+    SREG = sreg;
+    __asm__ __volatile__("" ::: "memory");
+    return (seconds);
+  }
+
+  /**
+   * Increment seconds counter and calendar. Should be called from an
+   * interrupt service routine once per second. See RTC::tick_isr().
+   */
+  void tick_isr()
+  {
+    m_time += 1;
+    m_calendar.add(1);
+  }
+
+  /**
+   * Set the current time (seconds) from epoch. The calendar is
+   * converted before entering the critical section.
+   */
+  void set_time(time_t time)
+  {
+    Calendar calendar;
+    calendar.set(time);
+    uint8_t sreg = SREG;
+    __asm__ __volatile__("cli" ::: "memory");
+    m_time = time;
+    m_calendar = calendar;
+    SREG = sreg;
+    __asm__ __volatile__("" ::: "memory");
+  }
+
+  /**
+   * Return the current time as a time structure.
+   */
+  void get_time(struct tm& now)
+  {
+    uint8_t sreg = SREG;
+    __asm__ __volatile__("cli" ::: "memory");
+    now = m_calendar.now();
+    SREG = sreg;
+    __asm__ __volatile__("" ::: "memory");
+  }
+
+  /**
+   * Set the current time based on the given time structure.
+   */
+  void set_time(struct tm& now)
+  {
+    zone_t zone;
+    get_zone(&zone);
+    set_time(now, zone);
+  }
+
+  /**
+   * Set the current time based on the given time structure and
+   * time zone.
+   */
+  void set_time(struct tm& now, zone_t& zone)
+  {
+    set_time(mktime_z(&now, &zone) + zone.offset);
+  }
+
+protected:
+  /** Current time as broken-down time. */
+  Calendar m_calendar;
+};
+
+#endif
@@ -29,7 +29,9 @@ public:
    */
   RTC() :
     m_millis(0),
-    m_time(0)
+    m_time(0),
+    m_trim(0),
+    m_drift(0)
   {}
 
   /**
@@ -39,7 +41,8 @@ public:
   bool tick()
   {
     uint16_t now = millis();
-    if (now - m_millis < 1000) return (false);
+    uint16_t length;
+    if (elapsed(now - m_millis, length, 1) == 0) return (false);
     uint8_t sreg = SREG;
     __asm__ __volatile__("cli" ::: "memory");
     m_time += 1;
@@ -49,6 +52,40 @@ public:
     return (true);
   }
 
+  /**
+   * Increment seconds counter with the number of whole seconds
+   * elapsed since the previous update. The remaining milliseconds
+   * are carried forward to the next update. Should be called at
+   * least once a minute. Return number of seconds applied.
+   * @return seconds.
+   */
+  uint16_t update()
+  {
+    uint16_t now = millis();
+    uint16_t length;
+    uint16_t seconds = elapsed(now - m_millis, length, UINT16_MAX);
+    if (seconds == 0) return (0);
+    uint8_t sreg = SREG;
+    __asm__ __volatile__("cli" ::: "memory");
+    m_time += seconds;
+    m_millis += length;
+    SREG = sreg;
+    __asm__ __volatile__("" ::: "memory");
+    return (seconds);
+  }
+
+  /**
+   * Increment seconds counter. Should be called from an interrupt
+   * service routine once per second, e.g. a timer compare match
+   * interrupt. Interrupts are disabled in the service routine, and
+   * reading and setting the time are critical sections, so the clock
+   * does not need tick() or update() calls.
+   */
+  void tick_isr()
+  {
+    m_time += 1;
+  }
+
   /**
    * Return the current time in seconds from epoch.
    */
@@ -62,6 +99,56 @@ public:
     return (res);
   }
 
+  /**
+   * Return the current time in seconds from epoch, and the
+   * milliseconds elapsed since the latest tick, scaled to the
+   * trimmed length of the current second. The milliseconds are
+   * limited to 999 until the next tick or update, and never carried
+   * into the seconds, so that the time is monotonic. The seconds and
+   * milliseconds are read in the same critical section. Requires
+   * tick() or update() to be used.
+   * @param[out] ms milliseconds [0-999].
+   * @return seconds from epoch.
+   */
+  time_t get_time(uint16_t& ms)
+  {
+    uint8_t sreg = SREG;
+    __asm__ __volatile__("cli" ::: "memory");
+    time_t res = m_time;
+    uint16_t elapsed = (uint16_t) millis() - m_millis;
+    uint16_t length = period();
+    SREG = sreg;
+    __asm__ __volatile__("" ::: "memory");
+    if (elapsed >= length)
+      ms = 999;
+    else
+      ms = (elapsed * 1000UL) / length;
+    return (res);
+  }
+
+  /**
+   * Return the current time with millisecond resolution.
+   * @param[out] tv time value.
+   */
+  void get_time(struct timeval& tv)
+  {
+    uint16_t ms;
+    tv.tv_sec = get_time(ms);
+    tv.tv_usec = ms * 1000L;
+  }
+
+  /**
+   * Return the current time as a time stamp with millisecond
+   * resolution.
+   * @return time stamp.
+   */
+  timestamp_t get_timestamp()
+  {
+    uint16_t ms;
+    time_t time = get_time(ms);
+    return (mk_timestamp(time, ms));
+  }
+
   /**
    * Set the current time (seconds) from epoch.
    */
@@ -88,16 +175,217 @@ public:
    */
   void set_time(struct tm& now)
   {
-    extern long __utc_offset;
-    set_time(mktime(&now) + __utc_offset);
+    zone_t zone;
+    get_zone(&zone);
+    set_time(now, zone);
+  }
+
+  /**
+   * Set the current time based on the given time structure and
+   * time zone.
+   */
+  void set_time(struct tm& now, zone_t& zone)
+  {
+    set_time(mktime_z(&now, &zone) + zone.offset);
   }
 
+  /**
+   * Return the clock trim; frequency error of millis() in ppm.
+   * Positive when millis() runs fast.
+   * @return trim.
+   */
+  int16_t trim() const
+  {
+    return (m_trim);
+  }
+
+  /**
+   * Set the clock trim; frequency error of millis() in ppm. The
+   * length of each second is adjusted with the trim. The trim is
+   * limited to TRIM_MAX.
+   * @param[in] ppm frequency error.
+   */
+  void trim(int16_t ppm)
+  {
+    if (ppm > TRIM_MAX) ppm = TRIM_MAX;
+    else if (ppm < -TRIM_MAX) ppm = -TRIM_MAX;
+    m_trim = ppm;
+  }
+
+  /**
+   * Save the clock trim to the static memory of the given device
+   * (DS1302 or DS1307) at the given address. Requires four bytes.
+   * Return true(1) if successful otherwise false(0).
+   * @param[in] dev device.
+   * @param[in] addr memory address on the device.
+   * @return bool.
+   */
+  template<typename DEVICE>
+  bool save_trim(DEVICE& dev, uint8_t addr)
+  {
+    int16_t buf[2] = { m_trim, (int16_t) ~m_trim };
+    return (dev.write_ram(addr, buf, sizeof(buf)));
+  }
+
+  /**
+   * Restore the clock trim from the static memory of the given
+   * device (DS1302 or DS1307) at the given address. Return true(1)
+   * if successful and a valid trim was found, otherwise false(0).
+   * @param[in] dev device.
+   * @param[in] addr memory address on the device.
+   * @return bool.
+   */
+  template<typename DEVICE>
+  bool restore_trim(DEVICE& dev, uint8_t addr)
+  {
+    int16_t buf[2];
+    if (!dev.read_ram(addr, buf, sizeof(buf))) return (false);
+    if (buf[0] != (int16_t) ~buf[1]) return (false);
+    trim(buf[0]);
+    return (true);
+  }
+
+  /**
+   * Calibration of the software clock against reference time, e.g.
+   * from a DS1302/DS1307 device or a host. The frequency error of
+   * millis() is estimated over the span from the first reference
+   * time and applied as trim. The span is restarted when it reaches
+   * SPAN_MAX, well before the millis() wrap around (49 days).
+   */
+  class Calibrator {
+  public:
+    /** Max measurement span (seconds). */
+    static const int32_t SPAN_MAX = 30 * ONE_DAY;
+
+    /** Min span of a restarted measurement before it is applied. */
+    static const int32_t SPAN_MIN = ONE_DAY;
+
+    /**
+     * Construct calibrator for the given software clock.
+     * @param[in] rtc software clock.
+     */
+    Calibrator(RTC& rtc) :
+      m_rtc(rtc),
+      m_reference(0),
+      m_millis(0),
+      m_started(false),
+      m_restarted(false)
+    {}
+
+    /**
+     * Update the calibration with the given reference time. The first
+     * call starts the measurement. Following calls estimate the
+     * frequency error from the start, and set the clock trim. The
+     * accuracy improves with the span, and when called just as the
+     * reference second changes. When the span reaches SPAN_MAX the
+     * measurement is restarted, and the trim is kept until the new
+     * span reaches SPAN_MIN. Should be called at least every SPAN_MAX
+     * seconds. Return estimated error (ppm).
+     * @param[in] reference time (seconds) from epoch.
+     * @return trim.
+     */
+    int16_t update(time_t reference)
+    {
+      uint32_t now = millis();
+      if (!m_started) {
+	m_reference = reference;
+	m_millis = now;
+	m_started = true;
+	return (m_rtc.trim());
+      }
+      int32_t span = reference - m_reference;
+      if (span <= 0) return (m_rtc.trim());
+      if (!m_restarted || span >= SPAN_MIN) {
+	int64_t error = (int64_t) (now - m_millis) - span * 1000LL;
+	int64_t ppm = (error * 1000) / span;
+	if (ppm > TRIM_MAX) ppm = TRIM_MAX;
+	else if (ppm < -TRIM_MAX) ppm = -TRIM_MAX;
+	m_rtc.trim(ppm);
+      }
+      if (span >= SPAN_MAX) {
+	m_reference = reference;
+	m_millis = now;
+	m_restarted = true;
+      }
+      return (m_rtc.trim());
+    }
+
+    /**
+     * Restart the measurement with the next reference time.
+     */
+    void reset()
+    {
+      m_started = false;
+      m_restarted = false;
+    }
+
+  protected:
+    RTC& m_rtc;			//!< Software clock to calibrate.
+    time_t m_reference;		//!< Reference time at start.
+    uint32_t m_millis;		//!< Milliseconds at start.
+    bool m_started;		//!< Measurement started.
+    bool m_restarted;		//!< Measurement restarted at max span.
+  };
+
 protected:
+  /** Max clock trim (ppm). */
+  static const int16_t TRIM_MAX = 10000;
+
   /** Timestamp for previous tick call. */
   volatile uint16_t m_millis;
 
   /** Current time from epoch. */
   volatile time_t m_time;
+
+  /** Clock trim; frequency error of millis() in ppm. */
+  int16_t m_trim;
+
+  /** Accumulated trim (micro-seconds) for the next second. */
+  int16_t m_drift;
+
+  /**
+   * Return the length of the current second in milliseconds; the
+   * period adjusted with the accumulated trim, as in elapsed().
+   * @return milliseconds.
+   */
+  uint16_t period() const
+  {
+    return (1000 + (m_drift + m_trim) / 1000);
+  }
+
+  /**
+   * Return number of whole seconds, up to the given max, within the
+   * given milliseconds since the previous tick, and the length of
+   * these seconds in milliseconds. The length of each second is
+   * adjusted with the accumulated trim.
+   * @param[in] ms milliseconds since previous tick.
+   * @param[out] length milliseconds of elapsed seconds.
+   * @param[in] max number of seconds.
+   * @return seconds.
+   */
+  uint16_t elapsed(uint16_t ms, uint16_t& length, uint16_t max)
+  {
+    uint16_t seconds = 0;
+    length = 0;
+    while (seconds < max) {
+      int16_t drift = m_drift + m_trim;
+      uint16_t period = 1000;
+      while (drift >= 1000) {
+	drift -= 1000;
+	period += 1;
+      }
+      while (drift <= -1000) {
+	drift += 1000;
+	period -= 1;
+      }
+      if (ms < period) break;
+      ms -= period;
+      length += period;
+      m_drift = drift;
+      seconds += 1;
+    }
+    return (seconds);
+  }
 };
 
 #endif
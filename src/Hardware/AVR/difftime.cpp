@@ -28,7 +28,11 @@
 
 #include "time.h"
 
+#if TIME_64
+int64_t
+#else
 int32_t
+#endif
 difftime(time_t t1, time_t t2)
 {
   return t1 - t2;
@@ -0,0 +1,51 @@
+/**
+ * @file Hardware/AVR/dst_transition.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "time.h"
+
+time_t
+dst_transition(int16_t year, int8_t mon, uint8_t week, int8_t wday,
+	       int32_t seconds)
+{
+  struct tm tmptr;
+  time_t res;
+  int8_t mday;
+  uint8_t days;
+
+  // Time stamp and day of week of the first day in the month
+  tmptr.tm_year = year - 1900;
+  tmptr.tm_mon = mon;
+  tmptr.tm_mday = 1;
+  res = mk_gmtime(&tmptr);
+  gmtime_r(&res, &tmptr);
+
+  // Day in month (zero based) of the first given day of week
+  mday = wday - tmptr.tm_wday;
+  if (mday < 0) mday += 7;
+
+  // Step to the given week, or the last within the month
+  mday += 7 * (week - 1);
+  mon += 1;
+  if (tmptr.tm_mon == FEBRUARY)
+    days = 28 + is_leap_year(year);
+  else
+    days = 30 + ((mon + (mon >> 3)) & 1);
+  while (mday >= days) mday -= 7;
+
+  return (res + mday * ONE_DAY + seconds);
+}
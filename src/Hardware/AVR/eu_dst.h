@@ -46,6 +46,12 @@
  * production applications it is recommended to write your own DST
  * function, which uses 'rules' obtained from, and modifiable by,
  * the end user ( perhaps stored in EEPROM ).
+ *
+ * The transition times are calculated once per year and cached.
+ * Following calls are answered with two comparisons until the next
+ * transition. The cache is read and updated with interrupts
+ * disabled, so the function may also be called from an interrupt
+ * service routine.
  */
 
 #ifndef EU_DST_H
@@ -55,49 +61,51 @@
 
 int eu_dst(const time_t* timer, int32_t* z)
 {
+  static dst_cache_t cache = { 0, 0, 0 };
+  dst_cache_t res;
   struct tm tmptr;
-  uint8_t month, mday, hour, day_of_week, d;
-  int n;
-
-  // Obtain the variables
-  gmtime_r(timer, &tmptr);
-  month = tmptr.tm_mon;
-  day_of_week = tmptr.tm_wday;
-  mday = tmptr.tm_mday - 1;
-  hour = tmptr.tm_hour;
-
-  if ((month > MARCH) && (month < OCTOBER))
-    return ONE_HOUR;
+  time_t start, end;
+  int16_t year;
+  uint8_t sreg;
 
-  if (month < MARCH)
-    return 0;
+  // Consistent copy of the cache
+  sreg = SREG;
+  __asm__ __volatile__("cli" ::: "memory");
+  res = cache;
+  SREG = sreg;
+  __asm__ __volatile__("" ::: "memory");
 
-  if (month > OCTOBER)
-    return 0;
+  // Daylight Saving is constant until the next transition
+  if ((*timer >= res.begin) && (*timer < res.end))
+    return (res.dst);
 
-  // Determine mday of last Sunday
-  n = tmptr.tm_mday - 1;
-  n -= day_of_week;
-  n += 7;
-  d = n % 7;
-  n = 31 - d;
-  n /= 7;
-  d = d + 7 * n;
-  if (month == MARCH) {
-    if (d < mday)
-      return 0;
-    if (d > mday)
-      return ONE_HOUR;
-    if (hour < 1)
-      return 0;
-    return ONE_HOUR;
+  // Transitions at 01:00 UTC on the last Sunday in March and October
+  gmtime_r(timer, &tmptr);
+  year = tmptr.tm_year + 1900;
+  start = dst_transition(year, MARCH, 5, SUNDAY, ONE_HOUR);
+  end = dst_transition(year, OCTOBER, 5, SUNDAY, ONE_HOUR);
+  if (*timer < start) {
+    res.begin = dst_transition(year - 1, OCTOBER, 5, SUNDAY, ONE_HOUR);
+    res.end = start;
+    res.dst = 0;
+  }
+  else if (*timer < end) {
+    res.begin = start;
+    res.end = end;
+    res.dst = ONE_HOUR;
   }
-  if (d < mday)
-    return ONE_HOUR;
-  if (d > mday)
-    return 0;
-  if (hour < 1)
-    return ONE_HOUR;
-  return 0;
+  else {
+    res.begin = end;
+    res.end = dst_transition(year + 1, MARCH, 5, SUNDAY, ONE_HOUR);
+    res.dst = 0;
+  }
+
+  // Update the cache
+  sreg = SREG;
+  __asm__ __volatile__("cli" ::: "memory");
+  cache = res;
+  SREG = sreg;
+  __asm__ __volatile__("" ::: "memory");
+  return (res.dst);
 }
 #endif
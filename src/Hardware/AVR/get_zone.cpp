@@ -0,0 +1,43 @@
+/**
+ * @file Hardware/AVR/get_zone.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "time.h"
+#include <avr/io.h>
+
+extern zone_t __zone;
+
+int32_t
+get_zone()
+{
+  uint8_t sreg = SREG;
+  __asm__ __volatile__("cli" ::: "memory");
+  int32_t res = __zone.offset;
+  SREG = sreg;
+  __asm__ __volatile__("" ::: "memory");
+  return (res);
+}
+
+void
+get_zone(zone_t* zone)
+{
+  uint8_t sreg = SREG;
+  __asm__ __volatile__("cli" ::: "memory");
+  *zone = __zone;
+  SREG = sreg;
+  __asm__ __volatile__("" ::: "memory");
+}
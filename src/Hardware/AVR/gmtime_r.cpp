@@ -27,6 +27,148 @@
  */
 
 #include "time.h"
+
+/**
+ * Configuration: Use the division-free calendar conversion. Define
+ * as zero(0) to use the original ldiv/div based conversion.
+ */
+#ifndef GMTIME_R_FAST
+#define GMTIME_R_FAST 1
+#endif
+
+#if TIME_64
+
+struct tm*
+gmtime_r(const time_t * timer, struct tm * timeptr)
+{
+  int32_t days, era, year;
+  uint32_t fract, doe, yoe;
+  uint16_t n;
+  uint8_t hour, min, mon;
+
+  // Break down timer into whole days (rounded down) and fraction
+  days = day_number(*timer);
+  fract = *timer - (int64_t) days * (int32_t) ONE_DAY;
+
+  // Extract hour, minute, and second with scaled reciprocals
+  hour = ((fract >> 4) * 4661UL) >> 20;
+  n = fract - hour * 3600U;
+  min = (n * 4370UL) >> 18;
+  timeptr->tm_sec = n - min * 60U;
+  timeptr->tm_min = min;
+  timeptr->tm_hour = hour;
+
+  // Determine day of week (the epoch was a Saturday)
+  n = (days % 7) + 7 + SATURDAY;
+  timeptr->tm_wday = n % 7;
+
+  /*
+   * Count days from March 1, 2000, and map into a 400 year cycle
+   * (era) of 146097 days. The year of era then starts with March
+   * and ends with the leap day. Within the era the 4 and 100 year
+   * cycles are removed to give the year.
+   */
+  days -= 60;
+  era = (days >= 0 ? days : days - 146096) / 146097;
+  doe = days - era * 146097;
+  yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  n = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  year = 2000 + era * 400 + yoe;
+
+  /*
+   * The months from March form a regular pattern of 153 days per
+   * 5 months. Map day of year into month (3..14) and day of month.
+   */
+  mon = (n * 2141UL + 197913UL) >> 16;
+  timeptr->tm_mday = n - ((979U * mon - 2919U) >> 5) + 1;
+
+  // Handle Jan/Feb as the end of the year, and add leap day
+  if (mon > 12) {
+    mon -= 12;
+    year++;
+    n -= 306;
+  }
+  else {
+    n += 59 + is_leap_year(year);
+  }
+  timeptr->tm_mon = mon - 1;
+  timeptr->tm_year = year - 1900;
+  timeptr->tm_yday = n;
+  timeptr->tm_isdst = 0;
+
+  return (timeptr);
+}
+
+#elif GMTIME_R_FAST
+
+struct tm*
+gmtime_r(const time_t * timer, struct tm * timeptr)
+{
+  uint32_t fract;
+  uint16_t days, n, start;
+  uint8_t years, mon, hour, min;
+
+  // Break down timer into whole and fractional parts of 1 day
+  days = day_number(*timer);
+  fract = *timer - days * 86400UL;
+
+  // Extract hour, minute, and second with scaled reciprocals
+  hour = ((fract >> 4) * 4661UL) >> 20;
+  n = fract - hour * 3600U;
+  min = (n * 4370UL) >> 18;
+  timeptr->tm_sec = n - min * 60U;
+  timeptr->tm_min = min;
+  timeptr->tm_hour = hour;
+
+  // Determine day of week (the epoch was a Saturday)
+  n = days + SATURDAY;
+  timeptr->tm_wday = n - ((n * 74899UL) >> 19) * 7;
+
+  /*
+   * Count days from March 1, 1996. The year then starts with
+   * March and ends with the leap day, and the years form a plain 4
+   * year leap cycle. The only exception within the range of time_t
+   * is 2100, which is handled by inserting the missing leap day.
+   */
+  n = days + 1401;
+  if (days >= 36584) n++;
+
+  // Map into a year. The reciprocal estimate may be one year ahead
+  years = ((n * 4UL + 3) * 2871UL) >> 22;
+  start = 365U * years + (years >> 2);
+  if (n < start) {
+    years--;
+    start = 365U * years + (years >> 2);
+  }
+  n -= start;
+
+  /*
+   * The months from March form a regular pattern of 153 days per
+   * 5 months. Map day of year into month (3..14) and day of month.
+   */
+  mon = (n * 2141UL + 197913UL) >> 16;
+  timeptr->tm_mday = n - ((979U * mon - 2919U) >> 5) + 1;
+
+  // Handle Jan/Feb as the end of the year, and add leap day
+  if (mon > 12) {
+    mon -= 12;
+    years++;
+    n -= 306;
+  }
+  else {
+    n += 59;
+    if (((years & 3) == 0) && (years != 104)) n++;
+  }
+  timeptr->tm_mon = mon - 1;
+  timeptr->tm_year = 96 + years;
+  timeptr->tm_yday = n;
+  timeptr->tm_isdst = 0;
+
+  return (timeptr);
+}
+
+#else
+
 #include <stdlib.h>
 
 struct tm*
@@ -44,7 +186,7 @@ gmtime_r(const time_t * timer, struct tm * timeptr)
   // Extract hour, minute, and second from the fractional day
   lresult = ldiv(fract, 60L);
   timeptr->tm_sec = lresult.rem;
-  result = div(lresult.quot, 60);
+  result = div((int) lresult.quot, 60);
   timeptr->tm_min = result.rem;
   timeptr->tm_hour = result.quot;
 
@@ -137,3 +279,5 @@ gmtime_r(const time_t * timer, struct tm * timeptr)
 
   return (timeptr);
 }
+
+#endif
@@ -26,10 +26,11 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "time.h"
 #include <stdlib.h>
 
-unsigned char
-is_leap_year(int year)
+uint8_t
+is_leap_year(int16_t year)
 {
   div_t d;
 
@@ -0,0 +1,180 @@
+/**
+ * @file Hardware/AVR/isotime_parse.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "time.h"
+
+/** Zone offset value when the string has no zone designator. */
+#define NO_ZONE INT32_MIN
+
+/**
+ * Parse the given number of decimal digits. Return pointer to next
+ * character or NULL if not a digit.
+ */
+static const char*
+parse_digits(const char* buf, uint8_t count, int16_t* value)
+{
+  int16_t res = 0;
+  do {
+    uint8_t digit = *buf - '0';
+    if (digit > 9) return (NULL);
+    res = res * 10 + digit;
+    buf++;
+  } while (--count);
+  *value = res;
+  return (buf);
+}
+
+const char*
+isotime_parse(const char* buf, struct tm* timeptr, int32_t* offset,
+	      uint16_t* ms)
+{
+  int16_t year, mon, mday, hour, min, sec, value;
+  uint16_t fract;
+  uint8_t n;
+
+  // Date; YYYY-MM-DD
+  if ((buf = parse_digits(buf, 4, &year)) == NULL) return (NULL);
+  if (*buf++ != '-') return (NULL);
+  if ((buf = parse_digits(buf, 2, &mon)) == NULL) return (NULL);
+  if (mon < 1 || mon > 12) return (NULL);
+  mon -= 1;
+  if (*buf++ != '-') return (NULL);
+  if ((buf = parse_digits(buf, 2, &mday)) == NULL) return (NULL);
+  if (mday < 1 || mday > days_in_month(year, mon)) return (NULL);
+
+  // Optional time; Thh:mm[:ss[.fff]]
+  hour = 0;
+  min = 0;
+  sec = 0;
+  fract = 0;
+  if (*buf == 'T' || *buf == ' ') {
+    if ((buf = parse_digits(buf + 1, 2, &hour)) == NULL) return (NULL);
+    if (hour > 23) return (NULL);
+    if (*buf++ != ':') return (NULL);
+    if ((buf = parse_digits(buf, 2, &min)) == NULL) return (NULL);
+    if (min > 59) return (NULL);
+    if (*buf == ':') {
+      if ((buf = parse_digits(buf + 1, 2, &sec)) == NULL) return (NULL);
+      if (sec > 60) return (NULL);
+      if (*buf == '.' || *buf == ',') {
+	buf += 1;
+	if (*buf < '0' || *buf > '9') return (NULL);
+	for (n = 0; *buf >= '0' && *buf <= '9'; buf++) {
+	  if (n == 3) continue;
+	  fract = fract * 10 + (*buf - '0');
+	  n += 1;
+	}
+	for (; n < 3; n++) fract *= 10;
+      }
+    }
+
+    // Optional zone designator; Z, +hh, +hh:mm or +hhmm
+    if (*buf == 'Z') {
+      if (offset != NULL) *offset = 0;
+      buf += 1;
+    }
+    else if (*buf == '+' || *buf == '-') {
+      bool negative = (*buf++ == '-');
+      int32_t zone;
+      if ((buf = parse_digits(buf, 2, &value)) == NULL) return (NULL);
+      if (value > 23) return (NULL);
+      zone = value * (int32_t) ONE_HOUR;
+      if (*buf == ':' || (*buf >= '0' && *buf <= '9')) {
+	if (*buf == ':') buf += 1;
+	if ((buf = parse_digits(buf, 2, &value)) == NULL) return (NULL);
+	if (value > 59) return (NULL);
+	zone += value * 60L;
+      }
+      if (offset != NULL) *offset = (negative ? -zone : zone);
+    }
+  }
+
+  // Assign broken-down time; day of week and year from the date
+  timeptr->tm_sec = sec;
+  timeptr->tm_min = min;
+  timeptr->tm_hour = hour;
+  timeptr->tm_mday = mday;
+  timeptr->tm_wday = day_of_week(year, mon, mday);
+  timeptr->tm_mon = mon;
+  timeptr->tm_year = year - 1900;
+  timeptr->tm_yday = mday - 1;
+  if (mon > JANUARY) timeptr->tm_yday += 31;
+  if (mon > FEBRUARY)
+    timeptr->tm_yday += 28 + leap_year(year)
+      + ((979U * (mon + 1) - 2919U) >> 5);
+  timeptr->tm_isdst = 0;
+  if (ms != NULL) *ms = fract;
+
+  return (buf);
+}
+
+/**
+ * Parse time stamp; a string without zone designator is local time
+ * in the given time zone, or the global time zone if NULL.
+ */
+static const char*
+parse_time(const char* buf, time_t* timer, uint16_t* ms, zone_t* zone)
+{
+  struct tm tmptr;
+  int32_t offset = NO_ZONE;
+  int64_t time;
+  time_t res;
+
+  if ((buf = isotime_parse(buf, &tmptr, &offset, ms)) == NULL)
+    return (NULL);
+
+  // Time stamp in 64-bit; the zone offset may move the time outside
+  // the time_t range
+  time = (int64_t) day_number(tmptr.tm_year + 1900, tmptr.tm_mon,
+			      tmptr.tm_mday) * (int32_t) ONE_DAY
+    + tmptr.tm_hour * (int32_t) ONE_HOUR
+    + tmptr.tm_min * 60L
+    + tmptr.tm_sec;
+  if (offset == NO_ZONE) {
+    tmptr.tm_isdst = -1;
+    res = (zone != NULL ? mktime_z(&tmptr, zone) : mktime(&tmptr));
+#if !TIME_64
+    // Local time outside the time_t range wraps around
+    if (((int64_t) res - time) > (int32_t) ONE_DAY
+	|| (time - (int64_t) res) > (int32_t) ONE_DAY)
+      return (NULL);
+#endif
+  }
+  else {
+    time -= offset;
+#if !TIME_64
+    if (time < 0 || time > UINT32_MAX) return (NULL);
+#endif
+    res = time;
+  }
+  *timer = res;
+
+  return (buf);
+}
+
+const char*
+isotime_parse(const char* buf, time_t* timer, uint16_t* ms)
+{
+  return (parse_time(buf, timer, ms, NULL));
+}
+
+const char*
+isotime_parse_z(const char* buf, time_t* timer, uint16_t* ms, zone_t* zone)
+{
+  return (parse_time(buf, timer, ms, zone));
+}
@@ -30,6 +30,92 @@
 
 extern void __print_lz(int , char *, char );
 
+/**
+ * Configuration: Use two digit lookup table (201 bytes program
+ * memory). Define as zero(0) to use the original __print_lz based
+ * formatting.
+ */
+#ifndef ISOTIME_R_TABLE
+#define ISOTIME_R_TABLE 1
+#endif
+
+#if ISOTIME_R_TABLE
+
+#include <avr/pgmspace.h>
+
+/** Two digit decimal representation of 00..99. */
+static const char digits[] PROGMEM =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+/**
+ * Write the two digits of the given value [0-99] to the buffer.
+ * Values outside the table, i.e. fields that are not normalized,
+ * are written as the original formatting. The character after the
+ * digits may be overwritten.
+ */
+#define PUT2(bp,v)							\
+  do {									\
+    int n = (v);							\
+    if ((unsigned) n < 100) {						\
+      uint16_t w = pgm_read_word(&digits[n * 2]);			\
+      memcpy(bp, &w, sizeof(w));					\
+    }									\
+    else {								\
+      __print_lz(n, bp, 0);						\
+    }									\
+  } while (0)
+
+uint8_t
+isotime_len(const struct tm* tm, char* buffer)
+{
+  char* bp = buffer;
+  int year = tm->tm_year + 1900;
+
+  // Year outside the table; as the original formatting
+  if (year < 0 || year > 9999) {
+    __print_lz(year / 100, bp, '-');
+    __print_lz(year % 100, bp + 2, '-');
+  }
+  else {
+    uint8_t century = (year * 5243UL) >> 19;
+    PUT2(bp, century);
+    PUT2(bp + 2, year - century * 100U);
+    bp[4] = '-';
+  }
+  PUT2(bp + 5, tm->tm_mon + 1);
+  bp[7] = '-';
+  PUT2(bp + 8, tm->tm_mday);
+  bp[10] = ' ';
+  PUT2(bp + 11, tm->tm_hour);
+  bp[13] = ':';
+  PUT2(bp + 14, tm->tm_min);
+  bp[16] = ':';
+  PUT2(bp + 17, tm->tm_sec);
+  bp[19] = 0;
+
+  return (19);
+}
+
+char*
+isotime_r(const struct tm* tm, char* buffer)
+{
+  isotime_len(tm, buffer);
+  return (buffer);
+}
+
+#else
+
+uint8_t
+isotime_len(const struct tm* tm, char* buffer)
+{
+  isotime_r(tm, buffer);
+  return (19);
+}
+
 char*
 isotime_r(const struct tm* tm, char* buffer)
 {
@@ -63,3 +149,5 @@ isotime_r(const struct tm* tm, char* buffer)
 
   return (buffer);
 }
+
+#endif
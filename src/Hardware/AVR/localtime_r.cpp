@@ -28,21 +28,11 @@
 
 #include "time.h"
 
-extern int32_t __utc_offset;
-extern int (*__dst_ptr) (const time_t *, int32_t *);
-
 struct tm*
 localtime_r(const time_t* timer, struct tm* timeptr)
 {
-  int16_t dst;
-  time_t lt;
-
-  dst = -1;
-  if (__dst_ptr) dst = __dst_ptr(timer, &__utc_offset);
-  lt = *timer + __utc_offset;
-  if (dst > 0) lt += dst;
-  gmtime_r(&lt, timeptr);
-  timeptr->tm_isdst = dst;
+  zone_t zone;
 
-  return (timeptr);
+  get_zone(&zone);
+  return (localtime_z(timer, timeptr, &zone));
 }
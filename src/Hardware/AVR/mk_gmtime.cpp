@@ -28,6 +28,49 @@
 
 #include "time.h"
 
+#if TIME_64
+
+time_t
+mk_gmtime(const struct tm * timeptr)
+{
+  int32_t year, mon, era, days;
+  uint32_t yoe;
+
+  // Normalize month, and handle Jan/Feb as the end of the year
+  year = timeptr->tm_year + 1900L;
+  mon = timeptr->tm_mon;
+  year += mon / 12;
+  mon %= 12;
+  if (mon < 0) {
+    mon += 12;
+    year -= 1;
+  }
+  if (mon < MARCH) {
+    mon += 12;
+    year -= 1;
+  }
+
+  /*
+   * Count days from March 1 of year zero with 400 year cycles (eras)
+   * of 146097 days, and the months from March as a regular pattern of
+   * 153 days per 5 months. Then rebase to the epoch.
+   */
+  era = (year >= 0 ? year : year - 399) / 400;
+  yoe = year - era * 400;
+  days = era * 146097L + 365 * yoe + yoe / 4 - yoe / 100
+    + ((979U * (mon + 1) - 2919U) >> 5)
+    + timeptr->tm_mday - 1
+    - 730425L;
+
+  // Convert to seconds and add the 'fractional' day
+  return ((int64_t) days * (int32_t) ONE_DAY
+	  + timeptr->tm_hour * (int32_t) ONE_HOUR
+	  + timeptr->tm_min * 60L
+	  + timeptr->tm_sec);
+}
+
+#else
+
 time_t
 mk_gmtime(const struct tm * timeptr)
 {
@@ -99,3 +142,5 @@ mk_gmtime(const struct tm * timeptr)
 
   return res;
 }
+
+#endif
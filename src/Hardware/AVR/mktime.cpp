@@ -28,23 +28,11 @@
 
 #include "time.h"
 
-extern int32_t __utc_offset;
-extern int (*__dst_ptr) (const time_t *, int32_t*);
-
 time_t
 mktime(struct tm * timeptr)
 {
-  time_t ret;
-
-  ret = mk_gmtime(timeptr);
-  if (timeptr->tm_isdst < 0) {
-    if (__dst_ptr)
-      timeptr->tm_isdst = __dst_ptr(&ret, &__utc_offset);
-  }
-  if (timeptr->tm_isdst > 0)
-    ret -= timeptr->tm_isdst;
-  ret -= __utc_offset;
-  localtime_r(&ret, timeptr);
+  zone_t zone;
 
-  return ret;
+  get_zone(&zone);
+  return (mktime_z(timeptr, &zone));
 }
@@ -27,11 +27,16 @@
  */
 
 #include "time.h"
+#include <avr/io.h>
 
-int (*__dst_ptr) (const time_t*, int32_t*) = 0;
+extern zone_t __zone;
 
 void
 set_dst(int (*d) (const time_t *, int32_t *))
 {
-  __dst_ptr = d;
+  uint8_t sreg = SREG;
+  __asm__ __volatile__("cli" ::: "memory");
+  set_dst(&__zone, d);
+  SREG = sreg;
+  __asm__ __volatile__("" ::: "memory");
 }
@@ -27,17 +27,16 @@
  */
 
 #include "time.h"
+#include <avr/io.h>
 
-int32_t __utc_offset = 0L;
+zone_t __zone = {};
 
 void
 set_zone(int32_t z)
 {
-  __utc_offset = z;
-}
-
-int32_t
-get_zone()
-{
-  return (__utc_offset);
+  uint8_t sreg = SREG;
+  __asm__ __volatile__("cli" ::: "memory");
+  set_zone(&__zone, z);
+  SREG = sreg;
+  __asm__ __volatile__("" ::: "memory");
 }
@@ -0,0 +1,329 @@
+/**
+ * @file Hardware/AVR/strftime.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "time.h"
+#include <avr/pgmspace.h>
+
+/** Abbreviated day of week and month names. */
+static const char days[] PROGMEM = "SunMonTueWedThuFriSat";
+static const char months[] PROGMEM = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+/**
+ * Formatting state; output function, character count and time zone
+ * of %s, or NULL for the global time zone.
+ */
+struct out_t {
+  strftime_put_t put;
+  void* arg;
+  size_t count;
+  zone_t* zone;
+};
+
+static void
+put_char(out_t* out, char c)
+{
+  out->put(out->arg, c);
+  out->count += 1;
+}
+
+static void
+put_name(out_t* out, const char* names, uint8_t index)
+{
+  const char* s = names + index * 3;
+  put_char(out, pgm_read_byte(s));
+  put_char(out, pgm_read_byte(s + 1));
+  put_char(out, pgm_read_byte(s + 2));
+}
+
+/**
+ * Print unsigned number with at least the given number of digits,
+ * padded with the given character. Seconds from the UNIX epoch are
+ * printed with 64-bit with TIME_64, otherwise as tens with 32-bit,
+ * all other fields are printed with 16-bit.
+ */
+template<typename T>
+static void
+put_digits(out_t* out, T value, uint8_t width, char pad)
+{
+  char buf[20];
+  uint8_t n = 0;
+  do {
+    T q = value / 10;
+    buf[n++] = (value - q * 10) + '0';
+    value = q;
+  } while (value != 0);
+  while (width > n) {
+    put_char(out, pad);
+    width -= 1;
+  }
+  while (n) put_char(out, buf[--n]);
+}
+
+static void
+put_number(out_t* out, uint16_t value, uint8_t width, char pad)
+{
+  put_digits<uint16_t>(out, value, width, pad);
+}
+
+/**
+ * Print year with at least four digits, and sign if negative.
+ */
+static void
+put_year(out_t* out, int16_t year)
+{
+  if (year < 0) {
+    put_char(out, '-');
+    year = -year;
+  }
+  put_number(out, year, 4, '0');
+}
+
+/**
+ * Return number of ISO 8601 weeks (52 or 53) in the given year.
+ * A year has 53 weeks if it starts on a Thursday, or is a leap year
+ * that starts on a Wednesday.
+ */
+static uint8_t
+iso_weeks(int16_t year)
+{
+  int16_t y = year - 1;
+  uint8_t p = (year + year / 4 - year / 100 + year / 400) % 7;
+  uint8_t q = (y + y / 4 - y / 100 + y / 400) % 7;
+  return (52 + (p == THURSDAY || q == WEDNESDAY));
+}
+
+/**
+ * Return ISO 8601 week [1-53] and year of the given broken-down time.
+ * Weeks start on Monday, and the first week of the year contains
+ * its first Thursday.
+ */
+static uint8_t
+iso_week(const struct tm* timeptr, int16_t* year)
+{
+  uint8_t wday = (timeptr->tm_wday == SUNDAY ? 7 : timeptr->tm_wday);
+  int16_t week = (timeptr->tm_yday - wday + 11) / 7;
+  *year = timeptr->tm_year + 1900;
+  if (week < 1) {
+    *year -= 1;
+    return (iso_weeks(*year));
+  }
+  if (week > iso_weeks(*year)) {
+    *year += 1;
+    return (1);
+  }
+  return (week);
+}
+
+static void
+format(out_t* out, const char* fmt, bool progmem, const struct tm* timeptr)
+{
+  int16_t year;
+  uint8_t week, hour;
+  time_t time;
+  char c;
+
+  while (true) {
+    c = progmem ? pgm_read_byte(fmt) : *fmt;
+    fmt += 1;
+    if (c == 0) return;
+    if (c != '%') {
+      put_char(out, c);
+      continue;
+    }
+    c = progmem ? pgm_read_byte(fmt) : *fmt;
+    if (c == 0) {
+      put_char(out, '%');
+      return;
+    }
+    fmt += 1;
+    switch (c) {
+    case 'a':
+      put_name(out, days, timeptr->tm_wday);
+      break;
+    case 'b':
+      put_name(out, months, timeptr->tm_mon);
+      break;
+    case 'd':
+      put_number(out, timeptr->tm_mday, 2, '0');
+      break;
+    case 'e':
+      put_number(out, timeptr->tm_mday, 2, ' ');
+      break;
+    case 'F':
+      put_year(out, timeptr->tm_year + 1900);
+      put_char(out, '-');
+      put_number(out, timeptr->tm_mon + 1, 2, '0');
+      put_char(out, '-');
+      put_number(out, timeptr->tm_mday, 2, '0');
+      break;
+    case 'G':
+      iso_week(timeptr, &year);
+      put_year(out, year);
+      break;
+    case 'H':
+      put_number(out, timeptr->tm_hour, 2, '0');
+      break;
+    case 'I':
+      hour = timeptr->tm_hour % 12;
+      put_number(out, hour == 0 ? 12 : hour, 2, '0');
+      break;
+    case 'j':
+      put_number(out, timeptr->tm_yday + 1, 3, '0');
+      break;
+    case 'm':
+      put_number(out, timeptr->tm_mon + 1, 2, '0');
+      break;
+    case 'M':
+      put_number(out, timeptr->tm_min, 2, '0');
+      break;
+    case 'p':
+      put_char(out, timeptr->tm_hour < 12 ? 'A' : 'P');
+      put_char(out, 'M');
+      break;
+    case 's':
+      {
+	struct tm tmptr = *timeptr;
+	time = (out->zone != NULL ? mktime_z(&tmptr, out->zone)
+		: mktime(&tmptr));
+      }
+#if TIME_64
+      if (time < -(time_t) UNIX_OFFSET) {
+	put_char(out, '-');
+	put_digits<uint64_t>(out, -(time + (time_t) UNIX_OFFSET), 1, '0');
+	break;
+      }
+      put_digits<uint64_t>(out, time + (uint64_t) UNIX_OFFSET, 1, '0');
+#else
+      // The offset is a multiple of ten; tens and the last digit
+      put_digits<uint32_t>(out, time / 10 + UNIX_OFFSET / 10, 1, '0');
+      put_char(out, '0' + time % 10);
+#endif
+      break;
+    case 'S':
+      put_number(out, timeptr->tm_sec, 2, '0');
+      break;
+    case 'T':
+      put_number(out, timeptr->tm_hour, 2, '0');
+      put_char(out, ':');
+      put_number(out, timeptr->tm_min, 2, '0');
+      put_char(out, ':');
+      put_number(out, timeptr->tm_sec, 2, '0');
+      break;
+    case 'u':
+      week = (timeptr->tm_wday == SUNDAY ? 7 : timeptr->tm_wday);
+      put_number(out, week, 1, '0');
+      break;
+    case 'V':
+      week = iso_week(timeptr, &year);
+      put_number(out, week, 2, '0');
+      break;
+    case 'w':
+      put_number(out, timeptr->tm_wday, 1, '0');
+      break;
+    case 'y':
+      put_number(out, (timeptr->tm_year % 100 + 100) % 100, 2, '0');
+      break;
+    case 'Y':
+      put_year(out, timeptr->tm_year + 1900);
+      break;
+    case '%':
+      put_char(out, '%');
+      break;
+    default:
+      put_char(out, '%');
+      put_char(out, c);
+    }
+  }
+}
+
+/** Buffer output state; next position and remaining size. */
+struct buf_t {
+  char* bp;
+  size_t left;
+};
+
+static void
+put_buf(void* arg, char c)
+{
+  buf_t* buf = (buf_t*) arg;
+  if (buf->left == 0) return;
+  *buf->bp++ = c;
+  buf->left -= 1;
+}
+
+static size_t
+format_buf(char* buf, size_t size, const char* fmt, bool progmem,
+	   const struct tm* timeptr, zone_t* zone)
+{
+  if (size == 0) return (0);
+  buf_t state = { buf, size - 1 };
+  out_t out = { put_buf, &state, 0, zone };
+  format(&out, fmt, progmem, timeptr);
+  *state.bp = 0;
+  if (out.count > size - 1) {
+    *buf = 0;
+    return (0);
+  }
+  return (out.count);
+}
+
+size_t
+strftime(char* buf, size_t size, const char* fmt, const struct tm* timeptr)
+{
+  return (format_buf(buf, size, fmt, false, timeptr, NULL));
+}
+
+size_t
+strftime_P(char* buf, size_t size, const char* fmt, const struct tm* timeptr)
+{
+  return (format_buf(buf, size, fmt, true, timeptr, NULL));
+}
+
+size_t
+strftime_put(strftime_put_t put, void* arg, const char* fmt,
+	     const struct tm* timeptr)
+{
+  out_t out = { put, arg, 0, NULL };
+  format(&out, fmt, false, timeptr);
+  return (out.count);
+}
+
+size_t
+strftime_put_P(strftime_put_t put, void* arg, const char* fmt,
+	       const struct tm* timeptr)
+{
+  out_t out = { put, arg, 0, NULL };
+  format(&out, fmt, true, timeptr);
+  return (out.count);
+}
+
+size_t
+strftime_z(char* buf, size_t size, const char* fmt, const struct tm* timeptr,
+	   zone_t* zone)
+{
+  return (format_buf(buf, size, fmt, false, timeptr, zone));
+}
+
+size_t
+strftime_put_z(strftime_put_t put, void* arg, const char* fmt,
+	       const struct tm* timeptr, zone_t* zone)
+{
+  out_t out = { put, arg, 0, zone };
+  format(&out, fmt, false, timeptr);
+  return (out.count);
+}
@@ -22,12 +22,31 @@
 #include <stdint.h>
 #include <string.h>
 
+/**
+ * Configuration: Use 64-bit signed time_t with the full Gregorian 400
+ * year leap cycle. Define as one(1) to represent time before the
+ * epoch and beyond 2136. Must be the same for the whole build, i.e.
+ * defined here or as a compiler option.
+ */
+#ifndef TIME_64
+#define TIME_64 0
+#endif
+
+#if TIME_64
+/**
+ * time_t represents seconds elapsed from Midnight, Jan 1 2000 UTC
+ * (the Y2K 'epoch'), negative before the epoch. The range is limited
+ * by tm_year to approximately the years -30000 to 30000.
+ */
+typedef int64_t time_t;
+#else
 /**
  * time_t represents seconds elapsed from Midnight, Jan 1 2000 UTC
  * (the Y2K 'epoch'). Its range allows this implementation to
  * represent time up to Tue Feb 7 06:28:15 2136 UTC.
  */
 typedef uint32_t time_t;
+#endif
 
 /**
  * The tm structure contains a representation of time 'broken down'
@@ -49,8 +68,8 @@ struct tm {
     memset(this, 0, sizeof(tm));
   }
 
-  tm(int8_t wday, int16_t year, int8_t mon, int8_t mday,
-     int8_t hour, int8_t min, int8_t sec) :
+  constexpr tm(int8_t wday, int16_t year, int8_t mon, int8_t mday,
+	       int8_t hour, int8_t min, int8_t sec) :
     tm_sec(sec),
     tm_min(min),
     tm_hour(hour),
@@ -64,6 +83,34 @@ struct tm {
   }
 } __attribute__((packed));
 
+/**
+ * The timeval structure represents time with microsecond resolution.
+ */
+struct timeval {
+  time_t tv_sec;	//!< Seconds from epoch.
+  int32_t tv_usec;	//!< Microseconds [0-999999].
+};
+
+#if TIME_64
+/**
+ * timestamp_t represents time from the epoch with sub-second
+ * resolution as a signed 48.16 fixed point number; seconds in the
+ * high 48 bits, and fraction of second (1/65536) in the low 16 bits.
+ * The fraction is always positive; a time stamp before the epoch is
+ * the second rounded down and the fraction after it.
+ */
+typedef int64_t timestamp_t;
+
+static_assert((((int64_t) -1) >> 1) == -1, "arithmetic shift required");
+#else
+/**
+ * timestamp_t represents time from the epoch with sub-second
+ * resolution as a 32.16 fixed point number; seconds in the high 32
+ * bits, and fraction of second (1/65536) in the low 16 bits.
+ */
+typedef uint64_t timestamp_t;
+#endif
+
 enum {
   SUNDAY,
   MONDAY,
@@ -91,9 +138,14 @@ enum {
 
 /**
  * The difftime function returns the difference between two binary
- * time stamps, time1 - time0.
+ * time stamps, time1 - time0. The difference is 32-bit, about 68
+ * years, or 64-bit with TIME_64.
  */
+#if TIME_64
+int64_t difftime(time_t time1, time_t time0);
+#else
 int32_t difftime(time_t time1, time_t time0);
+#endif
 
 /**
  * This function 'compiles' the elements of a broken-down time
@@ -139,6 +191,123 @@ struct tm* localtime_r(const time_t* timer, struct tm* timeptr);
  */
 char* isotime_r(const struct tm* tmptr, char* buf);
 
+/**
+ * The isotime function constructs an ascii string in the form
+ * \code YYYY-MM-DD hh:mm:ss\endcode and returns the length of the
+ * string (19), e.g. for appending to the string.
+ */
+uint8_t isotime_len(const struct tm* tmptr, char* buf);
+
+/**
+ * Character output function for time formatting; called with the
+ * given argument and each character.
+ */
+typedef void (*strftime_put_t)(void* arg, char c);
+
+/**
+ * The strftime function formats the broken-down time according to
+ * the given format string into the buffer of the given size. The
+ * following conversion specifiers are supported; %a %b %d %e %F %G
+ * %H %I %j %m %M %p %s %S %T %u %V %w %y %Y and %%. Other specifiers
+ * are copied as is. Returns the number of characters written, not
+ * including the null termination, or zero if the buffer is too small.
+ */
+size_t strftime(char* buf, size_t size, const char* fmt,
+		const struct tm* timeptr);
+
+/**
+ * The strftime function with the format string in program memory.
+ * See strftime().
+ */
+size_t strftime_P(char* buf, size_t size, const char* fmt,
+		  const struct tm* timeptr);
+
+/**
+ * The strftime function with character output. The formatted time
+ * is streamed to the output function without intermediate buffer.
+ * Returns the number of characters. See strftime().
+ */
+size_t strftime_put(strftime_put_t put, void* arg, const char* fmt,
+		    const struct tm* timeptr);
+
+/**
+ * The strftime function with character output and the format string
+ * in program memory. See strftime_put().
+ */
+size_t strftime_put_P(strftime_put_t put, void* arg, const char* fmt,
+		      const struct tm* timeptr);
+
+class __FlashStringHelper;
+
+/**
+ * Stream the broken-down time, formatted according to the given
+ * format string, to the given output, e.g. Serial. The output class
+ * should implement write(uint8_t). Example: \code
+ * strftime(Serial, F("%Y-%m-%d %H:%M:%S"), &now); \endcode
+ * @param[in] out output stream.
+ * @param[in] fmt format string in program memory.
+ * @param[in] timeptr broken-down time.
+ * @return number of characters.
+ */
+template<typename OUT>
+size_t strftime(OUT& out, const __FlashStringHelper* fmt,
+		const struct tm* timeptr)
+{
+  return (strftime_put_P([](void* arg, char c) {
+			   ((OUT*) arg)->write((uint8_t) c);
+			 },
+			 &out, (const char*) fmt, timeptr));
+}
+
+/**
+ * Stream the broken-down time, formatted according to the given
+ * format string, to the given output. See strftime().
+ * @param[in] out output stream.
+ * @param[in] fmt format string.
+ * @param[in] timeptr broken-down time.
+ * @return number of characters.
+ */
+template<typename OUT>
+size_t strftime(OUT& out, const char* fmt, const struct tm* timeptr)
+{
+  return (strftime_put([](void* arg, char c) {
+			 ((OUT*) arg)->write((uint8_t) c);
+		       },
+		       &out, fmt, timeptr));
+}
+
+/**
+ * The isotime parse function converts an ISO 8601 string in the
+ * extended form \code YYYY-MM-DD[Thh:mm[:ss[.fff]][Z|+hh[:mm]]]
+ * \endcode into broken-down time. The date and time separator may
+ * also be a space, as generated by isotime_r(). The fraction of
+ * second may have any number of digits, and is truncated to
+ * milliseconds. Each field is range checked. The zone offset
+ * (seconds East of UTC) is only assigned if the string contains a
+ * zone designator, otherwise it is left unchanged. Returns pointer
+ * to the character following the parsed string, or NULL on error.
+ * @param[in] buf string to parse.
+ * @param[out] timeptr broken-down time.
+ * @param[out] offset zone offset, or NULL.
+ * @param[out] ms milliseconds, or NULL.
+ * @return pointer to next character or NULL.
+ */
+const char* isotime_parse(const char* buf, struct tm* timeptr,
+			  int32_t* offset, uint16_t* ms);
+
+/**
+ * The isotime parse function converts an ISO 8601 string into a
+ * time stamp. A string without zone designator is converted as local
+ * time, see mktime(). Returns pointer to the character following
+ * the parsed string, or NULL on error or if the time is outside the
+ * time_t range.
+ * @param[in] buf string to parse.
+ * @param[out] timer time stamp.
+ * @param[out] ms milliseconds, or NULL.
+ * @return pointer to next character or NULL.
+ */
+const char* isotime_parse(const char* buf, time_t* timer, uint16_t* ms);
+
 /**
  * Return 1 if year is a leap year, zero if it is not.
  */
@@ -159,6 +328,209 @@ uint8_t is_leap_year(int16_t year);
 /** Difference between the Y2K and the NTP epochs, in seconds. */
 #define NTP_OFFSET 3155673600UL
 
+#if TIME_64
+/**
+ * Return number of whole days from the epoch for the given time
+ * stamp; rounded down before the epoch.
+ */
+inline int32_t day_number(time_t time)
+{
+  int32_t days = time / (int32_t) ONE_DAY;
+  if (time < (int64_t) days * (int32_t) ONE_DAY) days -= 1;
+  return (days);
+}
+
+/**
+ * Return seconds from midnight [0-86399] for the given time stamp.
+ */
+inline uint32_t time_of_day(time_t time)
+{
+  return (time - (int64_t) day_number(time) * (int32_t) ONE_DAY);
+}
+
+/**
+ * Return day of week [0-6], days since Sunday, for the given time
+ * stamp.
+ */
+inline uint8_t weekday(time_t time)
+{
+  return (((day_number(time) % 7) + 7 + SATURDAY) % 7);
+}
+#else
+/**
+ * Return number of whole days from the epoch for the given time
+ * stamp. The reciprocal estimate (2^30 / 86400) is at most a few
+ * days short, and is adjusted with the remaining seconds. See
+ * gmtime_r().
+ */
+inline uint16_t day_number(time_t time)
+{
+  uint16_t days = ((time >> 16) * 12427UL) >> 14;
+  uint32_t fract = time - days * ONE_DAY;
+  while (fract >= ONE_DAY) {
+    fract -= ONE_DAY;
+    days++;
+  }
+  return (days);
+}
+
+/**
+ * Return seconds from midnight [0-86399] for the given time stamp.
+ */
+inline uint32_t time_of_day(time_t time)
+{
+  return (time - day_number(time) * ONE_DAY);
+}
+
+/**
+ * Return day of week [0-6], days since Sunday, for the given time
+ * stamp (the epoch was a Saturday).
+ */
+inline uint8_t weekday(time_t time)
+{
+  uint16_t n = day_number(time) + SATURDAY;
+  return (n - ((n * 74899UL) >> 19) * 7);
+}
+#endif
+
+/**
+ * Return hour [0-23] for the given time stamp. These functions do
+ * not break down the date; use time + get_zone() for local
+ * standard time. Example: \code
+ * uint8_t h = hour(rtc.get_time() + get_zone());
+ * if (h >= 6 && h < 22) ... \endcode
+ */
+inline uint8_t hour(time_t time)
+{
+  return (((time_of_day(time) >> 4) * 4661UL) >> 20);
+}
+
+/**
+ * Return minute [0-59] for the given time stamp.
+ */
+inline uint8_t minute(time_t time)
+{
+  uint32_t fract = time_of_day(time);
+  uint8_t hour = ((fract >> 4) * 4661UL) >> 20;
+  uint16_t n = fract - hour * 3600U;
+  return ((n * 4370UL) >> 18);
+}
+
+/**
+ * Compile-time calendar functions. The functions are single
+ * expression constexpr (C++11) and are evaluated by the compiler
+ * when the arguments are constants. Use the mk_time() template to
+ * construct time stamp constants with validation, e.g. \code
+ * const time_t ALARM = mk_time<2017, MARCH, 26, 2, 0, 0>(); \endcode
+ */
+
+/**
+ * Return true if year is a leap year, otherwise false. See
+ * is_leap_year().
+ */
+constexpr bool leap_year(int16_t year)
+{
+  return ((year % 4 == 0) && ((year % 100 != 0) || (year % 400 == 0)));
+}
+
+/**
+ * Return number of days in the given month and year.
+ */
+constexpr uint8_t days_in_month(int16_t year, int8_t mon)
+{
+  return (mon == FEBRUARY ?
+	  28 + leap_year(year) :
+	  30 + (((mon + 1) + ((mon + 1) >> 3)) & 1));
+}
+
+/**
+ * Return number of days from March 1, year zero, for the given day
+ * of year (from March) in the given year. Leap cycles are counted
+ * in 400 year eras of 146097 days.
+ */
+constexpr int32_t days_from_march(int32_t year, int32_t era, int16_t day)
+{
+  return (era * 146097L
+	  + (year - era * 400) * 365L
+	  + (year - era * 400) / 4
+	  - (year - era * 400) / 100
+	  + day);
+}
+
+/**
+ * Return number of days from the epoch for the given date. The
+ * months from March form a regular pattern of 153 days per 5 months,
+ * with Jan/Feb at the end of the previous year. See mk_gmtime().
+ */
+constexpr int32_t day_number(int16_t year, int8_t mon, int8_t mday)
+{
+  return (days_from_march(year - (mon < MARCH),
+			  ((year - (mon < MARCH)) >= 0 ?
+			   (year - (mon < MARCH)) :
+			   (year - (mon < MARCH)) - 399) / 400,
+			  ((979U * (mon + (mon < MARCH ? 13 : 1)) - 2919U) >> 5)
+			  + mday - 1)
+	  - 730425L);
+}
+
+/**
+ * Return day of week [0-6], days since Sunday, for the given date.
+ */
+constexpr uint8_t day_of_week(int16_t year, int8_t mon, int8_t mday)
+{
+  return (((day_number(year, mon, mday) % 7) + 7 + SATURDAY) % 7);
+}
+
+/**
+ * Return true if the given date and time is valid, otherwise false.
+ */
+constexpr bool valid_time(int16_t year, int8_t mon, int8_t mday,
+			  int8_t hour, int8_t min, int8_t sec)
+{
+  return ((mon >= JANUARY) && (mon <= DECEMBER)
+	  && (mday >= 1) && (mday <= days_in_month(year, mon))
+	  && (hour >= 0) && (hour < 24)
+	  && (min >= 0) && (min < 60)
+	  && (sec >= 0) && (sec < 60));
+}
+
+/**
+ * Return time stamp for the given date and time (UTC). Evaluated
+ * at compile-time when the arguments are constants. The arguments
+ * are not validated; see the mk_time() template.
+ */
+constexpr time_t mk_time(int16_t year, int8_t mon, int8_t mday,
+			 int8_t hour = 0, int8_t min = 0, int8_t sec = 0)
+{
+  return ((time_t) day_number(year, mon, mday) * ONE_DAY
+	  + hour * (int32_t) ONE_HOUR
+	  + min * 60L
+	  + sec);
+}
+
+/**
+ * Return time stamp constant for the given date and time (UTC).
+ * Invalid dates and dates outside the time_t range are compile-time
+ * errors.
+ * @param[in] YEAR year, e.g. 2017.
+ * @param[in] MON month [0-11], e.g. MARCH.
+ * @param[in] MDAY day in month [1-31].
+ * @param[in] HOUR hour [0-23] (default 0).
+ * @param[in] MIN minute [0-59] (default 0).
+ * @param[in] SEC second [0-59] (default 0).
+ * @return time stamp.
+ */
+template<int16_t YEAR, int8_t MON, int8_t MDAY,
+	 int8_t HOUR = 0, int8_t MIN = 0, int8_t SEC = 0>
+constexpr time_t mk_time()
+{
+  static_assert(valid_time(YEAR, MON, MDAY, HOUR, MIN, SEC),
+		"invalid date or time");
+  static_assert(TIME_64 || ((YEAR >= 2000) && (YEAR < 2136)),
+		"date outside time_t range");
+  return (mk_time(YEAR, MON, MDAY, HOUR, MIN, SEC));
+}
+
 /**
  * Specify the Daylight Saving function. The Daylight Saving function
  * should examine its parameters to determine whether Daylight Saving
@@ -169,6 +541,132 @@ uint8_t is_leap_year(int16_t year);
  */
 void set_dst(int (*)(const time_t*, int32_t*));
 
+/**
+ * Daylight Saving state cache. Holds the interval of time stamps
+ * with the same Daylight Saving state, i.e. between two transitions,
+ * so that Daylight Saving functions only need to evaluate their
+ * rules when the time stamp leaves the interval.
+ */
+struct dst_cache_t {
+  time_t begin;		//!< Start of interval (inclusive).
+  time_t end;		//!< End of interval (exclusive).
+  int16_t dst;		//!< Daylight Saving (seconds) within interval.
+};
+
+/**
+ * Return time stamp of the given week (1..4, or 5 for last) and day
+ * of week in the given month and year, at the given number of seconds
+ * from the start of that day. Used to calculate Daylight Saving
+ * transitions.
+ */
+time_t dst_transition(int16_t year, int8_t mon, uint8_t week, int8_t wday,
+		      int32_t seconds);
+
+/**
+ * Daylight Saving transition rule; day of week in the given week of
+ * the month, at the given local time. See POSIX TZ rule Mm.w.d/time.
+ */
+struct zone_rule_t {
+  uint8_t mon:4;	//!< Month [0-11].
+  uint8_t week:4;	//!< Week in month [1-5], 5 for last.
+  uint8_t wday;		//!< Day of week [0-6].
+  int16_t time;		//!< Local time of transition in minutes.
+} __attribute__((packed));
+
+/**
+ * Compact time zone rule; standard time offset, Daylight Saving and
+ * transition rules. May be stored in program memory.
+ */
+struct zone_info_t {
+  int8_t offset;	//!< Standard time, quarter hours East of UTC.
+  uint8_t save;		//!< Daylight Saving in quarter hours, zero if none.
+  zone_rule_t start;	//!< Start of Daylight Saving (local standard time).
+  zone_rule_t end;	//!< End of Daylight Saving (local daylight time).
+} __attribute__((packed));
+
+/**
+ * Time zone; standard time offset, Daylight Saving function or rule,
+ * and Daylight Saving state cache. The global time zone, set_zone()
+ * and set_dst(), is a time zone object. Conversion with a time zone
+ * object does not read the global time zone, and may be used from
+ * several contexts, e.g. an interrupt service routine, with
+ * different time zones. Each context should use its own zone
+ * object. A Daylight Saving function must be reentrant for
+ * concurrent use; eu_dst() and usa_dst() share a cache.
+ */
+struct zone_t {
+  int32_t offset;			//!< Standard time, seconds East of UTC.
+  int (*dst)(const time_t*, int32_t*);	//!< Daylight Saving or null.
+  zone_info_t info;			//!< Rule, used when dst is null.
+  dst_cache_t cache;			//!< Daylight Saving state cache.
+};
+
+/**
+ * Initiate time zone with the given rule.
+ */
+void zone_init(zone_t* zone, const zone_info_t* info);
+
+/**
+ * Initiate time zone with the given rule in program memory.
+ */
+void zone_init_P(zone_t* zone, const zone_info_t* info);
+
+/**
+ * Compile the given POSIX TZ string, e.g. \code
+ * "CET-1CEST,M3.5.0,M10.5.0/3" \endcode to a time zone rule. Only
+ * the Mm.w.d transition rule format is supported; not Jn or n.
+ * Offsets must be in quarter hours, and within 24 hours. Transition
+ * times may be negative or beyond 24 hours, within 167 hours (RFC
+ * 8536). Return zero if successful otherwise -1.
+ */
+int zone_parse(zone_info_t* info, const char* tz);
+
+/**
+ * Return Daylight Saving (seconds) in the given time zone for the
+ * time stamp (UTC) pointed to by timer, or -1 if the zone has
+ * neither a Daylight Saving function nor a Daylight Saving rule.
+ */
+int16_t zone_dst(const time_t* timer, zone_t* zone);
+
+/**
+ * The localtime function converts the time stamp pointed to by timer
+ * into broken-down time, expressed as local time in the given time
+ * zone.
+ */
+struct tm* localtime_z(const time_t* timer, struct tm* timeptr, zone_t* zone);
+
+/**
+ * This function 'compiles' the elements of a broken-down time
+ * structure, interpreted as local time in the given time zone,
+ * returning a binary time stamp. If tm_isdst is positive the
+ * Daylight Saving of the zone is applied; with a Daylight Saving
+ * function tm_isdst is the Daylight Saving in seconds. See mktime().
+ */
+time_t mktime_z(struct tm* timeptr, zone_t* zone);
+
+/**
+ * The strftime function with %s, the time stamp, computed from the
+ * broken-down time as local time in the given time zone. See
+ * strftime().
+ */
+size_t strftime_z(char* buf, size_t size, const char* fmt,
+		  const struct tm* timeptr, zone_t* zone);
+
+/**
+ * The strftime function with character output and %s as local time
+ * in the given time zone. See strftime_put() and strftime_z().
+ */
+size_t strftime_put_z(strftime_put_t put, void* arg, const char* fmt,
+		      const struct tm* timeptr, zone_t* zone);
+
+/**
+ * The isotime parse function with a string without zone designator
+ * converted as local time in the given time zone, see mktime_z().
+ * See isotime_parse().
+ */
+const char* isotime_parse_z(const char* buf, time_t* timer, uint16_t* ms,
+			    zone_t* zone);
+
 /**
  * Set the 'time zone'. The parameter is given in seconds East of the
  * Prime Meridian. Example for New York City: \code set_zone(-5 *
@@ -178,4 +676,68 @@ void set_dst(int (*)(const time_t*, int32_t*));
  */
 void set_zone(int32_t);
 int32_t get_zone();
+
+/**
+ * Set the standard time offset of the given time zone. The
+ * parameter is given in seconds East of the Prime Meridian.
+ */
+void set_zone(zone_t* zone, int32_t offset);
+
+/**
+ * Set the Daylight Saving function of the given time zone, see
+ * set_dst(). The function is used instead of the rule of the zone.
+ */
+void set_dst(zone_t* zone, int (*)(const time_t*, int32_t*));
+
+/**
+ * Return a consistent copy of the global time zone, i.e. set_zone()
+ * and set_dst(), in the given time zone object.
+ */
+void get_zone(zone_t* zone);
+
+/**
+ * Construct a time stamp from the given time (seconds) from epoch
+ * and milliseconds.
+ * @param[in] time seconds from epoch.
+ * @param[in] ms milliseconds [0-999].
+ * @return time stamp.
+ */
+inline timestamp_t mk_timestamp(time_t time, uint16_t ms)
+{
+  return ((((timestamp_t) time) * 0x10000L) | ((ms * 4294967UL + 0xffff) >> 16));
+}
+
+/**
+ * Return the time (seconds) from epoch of the given time stamp.
+ * With TIME_64 the shift of the signed time stamp is arithmetic
+ * (GCC), i.e. rounded down before the epoch.
+ * @param[in] ts time stamp.
+ * @return seconds from epoch.
+ */
+inline time_t timestamp_time(timestamp_t ts)
+{
+  return (ts >> 16);
+}
+
+/**
+ * Return the milliseconds of the given time stamp.
+ * @param[in] ts time stamp.
+ * @return milliseconds [0-999].
+ */
+inline uint16_t timestamp_ms(timestamp_t ts)
+{
+  return ((((uint16_t) ts) * 1000UL) >> 16);
+}
+
+/**
+ * The gmtime function converts the time stamp pointed to by timer
+ * into broken-down time, expressed as UTC, and milliseconds.
+ */
+inline struct tm* gmtime_r(const timestamp_t* timer, struct tm* timeptr,
+			   uint16_t* ms)
+{
+  time_t time = timestamp_time(*timer);
+  *ms = timestamp_ms(*timer);
+  return (gmtime_r(&time, timeptr));
+}
 #endif
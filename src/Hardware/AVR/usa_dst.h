@@ -45,13 +45,18 @@
  * production applications it is recommended to write your own DST
  * function, which uses 'rules' obtained from, and modifiable by,
  * the end user ( perhaps stored in EEPROM ).
+ *
+ * The transition times are calculated once per year and cached.
+ * Following calls are answered with two comparisons until the next
+ * transition. The cache is read and updated with interrupts
+ * disabled, so the function may also be called from an interrupt
+ * service routine.
  */
 
 #ifndef USA_DST_H
 #define USA_DST_H
 
-#include <time.h>
-#include <inttypes.h>
+#include "time.h"
 
 #ifndef DST_START_MONTH
 #define DST_START_MONTH MARCH
@@ -71,48 +76,65 @@
 
 int usa_dst(const time_t * timer, int32_t * z)
 {
-  time_t t;
+  static dst_cache_t cache = { 0, 0, 0 };
+  static int32_t cache_zone = 0;
+  dst_cache_t res;
+  int32_t zone;
   struct tm tmptr;
-  uint8_t month, week, hour, day_of_week, d;
-  int n;
-
-  // Obtain the variables
-  t = *timer + *z;
-  gmtime_r(&t, &tmptr);
-  month = tmptr.tm_mon;
-  day_of_week = tmptr.tm_wday;
-  week = week_of_month(&tmptr, 0);
-  hour = tmptr.tm_hour;
-
-  if ((month > DST_START_MONTH) && (month < DST_END_MONTH))
-    return ONE_HOUR;
+  time_t t, start, end;
+  int16_t year;
+  uint8_t sreg;
 
-  if (month < DST_START_MONTH)
-    return 0;
-  if (month > DST_END_MONTH)
-    return 0;
+  // Consistent copy of the cache and zone
+  sreg = SREG;
+  __asm__ __volatile__("cli" ::: "memory");
+  res = cache;
+  zone = cache_zone;
+  SREG = sreg;
+  __asm__ __volatile__("" ::: "memory");
 
-  if (month == DST_START_MONTH) {
-    if (week < DST_START_WEEK)
-      return 0;
-    if (week > DST_START_WEEK)
-      return ONE_HOUR;
+  // Daylight Saving is constant until the next transition
+  if ((*timer >= res.begin) && (*timer < res.end) && (*z == zone))
+    return (res.dst);
 
-    if (day_of_week > SUNDAY)
-      return ONE_HOUR;
-    if (hour >= 2)
-      return ONE_HOUR;
-    return 0;
+  /*
+   * Transitions on Sunday, at 02:00 local standard time at the start
+   * and 02:00 local daylight time at the end, i.e. 01:00 local
+   * standard time.
+   */
+  zone = *z;
+  t = *timer + zone;
+  gmtime_r(&t, &tmptr);
+  year = tmptr.tm_year + 1900;
+  start = dst_transition(year, DST_START_MONTH, DST_START_WEEK, SUNDAY,
+			 2 * ONE_HOUR - zone);
+  end = dst_transition(year, DST_END_MONTH, DST_END_WEEK, SUNDAY,
+		       ONE_HOUR - zone);
+  if (*timer < start) {
+    res.begin = dst_transition(year - 1, DST_END_MONTH, DST_END_WEEK,
+			       SUNDAY, ONE_HOUR - zone);
+    res.end = start;
+    res.dst = 0;
+  }
+  else if (*timer < end) {
+    res.begin = start;
+    res.end = end;
+    res.dst = ONE_HOUR;
+  }
+  else {
+    res.begin = end;
+    res.end = dst_transition(year + 1, DST_START_MONTH, DST_START_WEEK,
+			     SUNDAY, 2 * ONE_HOUR - zone);
+    res.dst = 0;
   }
 
-  if (week > DST_END_WEEK)
-    return 0;
-  if (week < DST_END_WEEK)
-    return ONE_HOUR;
-  if (day_of_week > SUNDAY)
-    return 0;
-  if (hour >= 1)
-    return 0;
-  return ONE_HOUR;
+  // Update the cache
+  sreg = SREG;
+  __asm__ __volatile__("cli" ::: "memory");
+  cache = res;
+  cache_zone = zone;
+  SREG = sreg;
+  __asm__ __volatile__("" ::: "memory");
+  return (res.dst);
 }
 #endif
@@ -0,0 +1,180 @@
+/**
+ * @file Hardware/AVR/zone.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "time.h"
+#include <avr/pgmspace.h>
+
+/** One quarter of an hour, expressed in seconds. */
+#define ONE_QUARTER (ONE_HOUR / 4)
+
+void
+zone_init(zone_t* zone, const zone_info_t* info)
+{
+  memcpy(&zone->info, info, sizeof(zone_info_t));
+  memset(&zone->cache, 0, sizeof(dst_cache_t));
+  zone->offset = zone->info.offset * (int32_t) ONE_QUARTER;
+  zone->dst = NULL;
+}
+
+void
+zone_init_P(zone_t* zone, const zone_info_t* info)
+{
+  memcpy_P(&zone->info, info, sizeof(zone_info_t));
+  memset(&zone->cache, 0, sizeof(dst_cache_t));
+  zone->offset = zone->info.offset * (int32_t) ONE_QUARTER;
+  zone->dst = NULL;
+}
+
+void
+set_zone(zone_t* zone, int32_t offset)
+{
+  zone->offset = offset;
+  memset(&zone->cache, 0, sizeof(dst_cache_t));
+}
+
+void
+set_dst(zone_t* zone, int (*dst)(const time_t*, int32_t*))
+{
+  zone->dst = dst;
+}
+
+static time_t
+zone_transition(const zone_rule_t* rule, int16_t year, int32_t offset)
+{
+  return (dst_transition(year, rule->mon, rule->week, rule->wday,
+			 rule->time * 60L - offset));
+}
+
+int16_t
+zone_dst(const time_t* timer, zone_t* zone)
+{
+  const zone_info_t* info = &zone->info;
+  dst_cache_t* cache = &zone->cache;
+  const zone_rule_t* first;
+  const zone_rule_t* second;
+  int32_t offset, save, first_offset, second_offset;
+  int16_t inside, outside, year;
+  time_t t, start, end;
+  struct tm tmptr;
+
+  // Daylight Saving function; given the standard time offset
+  offset = zone->offset;
+  if (zone->dst) return (zone->dst(timer, &offset));
+
+  // Daylight Saving is constant until the next transition
+  if (info->save == 0) return (-1);
+  if ((*timer >= cache->begin) && (*timer < cache->end))
+    return (cache->dst);
+
+  // Year in local standard time
+  save = info->save * (int32_t) ONE_QUARTER;
+  t = *timer + offset;
+  gmtime_r(&t, &tmptr);
+  year = tmptr.tm_year + 1900;
+
+  /*
+   * Transitions in UTC. The start rule is given in local standard
+   * time and the end rule in local daylight time. Order the
+   * transitions within the year; on the southern hemisphere
+   * Daylight Saving ends before it starts.
+   */
+  start = zone_transition(&info->start, year, offset);
+  end = zone_transition(&info->end, year, offset + save);
+  if (start < end) {
+    first = &info->start;
+    first_offset = offset;
+    second = &info->end;
+    second_offset = offset + save;
+    inside = save;
+    outside = 0;
+  }
+  else {
+    first = &info->end;
+    first_offset = offset + save;
+    second = &info->start;
+    second_offset = offset;
+    inside = 0;
+    outside = save;
+    t = start;
+    start = end;
+    end = t;
+  }
+
+  // Cache the interval between the transitions
+  if (*timer < start) {
+    cache->begin = zone_transition(second, year - 1, second_offset);
+    cache->end = start;
+    cache->dst = outside;
+  }
+  else if (*timer < end) {
+    cache->begin = start;
+    cache->end = end;
+    cache->dst = inside;
+  }
+  else {
+    cache->begin = end;
+    cache->end = zone_transition(first, year + 1, first_offset);
+    cache->dst = outside;
+  }
+  return (cache->dst);
+}
+
+struct tm*
+localtime_z(const time_t* timer, struct tm* timeptr, zone_t* zone)
+{
+  int16_t dst;
+  time_t lt;
+
+  dst = zone_dst(timer, zone);
+  lt = *timer + zone->offset;
+  if (dst > 0) lt += dst;
+  gmtime_r(&lt, timeptr);
+  timeptr->tm_isdst = dst;
+
+  return (timeptr);
+}
+
+time_t
+mktime_z(struct tm* timeptr, zone_t* zone)
+{
+  int32_t offset;
+  time_t ret;
+
+  // A Daylight Saving function is given the local time and the
+  // result is the Daylight Saving in seconds, as for mktime()
+  ret = mk_gmtime(timeptr);
+  if (zone->dst) {
+    if (timeptr->tm_isdst < 0) {
+      offset = zone->offset;
+      timeptr->tm_isdst = zone->dst(&ret, &offset);
+    }
+    if (timeptr->tm_isdst > 0)
+      ret -= timeptr->tm_isdst;
+    ret -= zone->offset;
+  }
+  else {
+    ret -= zone->offset;
+    if (timeptr->tm_isdst < 0)
+      timeptr->tm_isdst = zone_dst(&ret, zone);
+    if (timeptr->tm_isdst > 0)
+      ret -= zone->info.save * (int32_t) ONE_QUARTER;
+  }
+  localtime_z(&ret, timeptr, zone);
+
+  return (ret);
+}
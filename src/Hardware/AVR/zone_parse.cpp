@@ -0,0 +1,133 @@
+/**
+ * @file Hardware/AVR/zone_parse.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "time.h"
+
+/** One quarter of an hour, expressed in seconds. */
+#define ONE_QUARTER (ONE_HOUR / 4)
+
+/** Max time zone offset (seconds); POSIX hours 0-24. */
+#define OFFSET_MAX (24 * (int32_t) ONE_HOUR)
+
+/** Max transition time (seconds); RFC 8536 extension, hours -167-167. */
+#define RULE_MAX (167 * (int32_t) ONE_HOUR)
+
+static const char*
+parse_number(const char* tz, int16_t* value)
+{
+  if (*tz < '0' || *tz > '9') return (0);
+  *value = 0;
+  while (*tz >= '0' && *tz <= '9') {
+    *value = *value * 10 + (*tz++ - '0');
+    if (*value > 999) return (0);
+  }
+  return (tz);
+}
+
+static const char*
+parse_name(const char* tz)
+{
+  uint8_t n = 0;
+  if (*tz == '<') {
+    while (*++tz != '>')
+      if (*tz == 0) return (0);
+    return (tz + 1);
+  }
+  while ((*tz >= 'A' && *tz <= 'Z') || (*tz >= 'a' && *tz <= 'z')) {
+    tz++;
+    n++;
+  }
+  return (n < 3 ? 0 : tz);
+}
+
+static const char*
+parse_time(const char* tz, int32_t* seconds)
+{
+  int16_t value;
+  bool negative = false;
+  if (*tz == '+' || *tz == '-') negative = (*tz++ == '-');
+  if ((tz = parse_number(tz, &value)) == 0) return (0);
+  *seconds = value * (int32_t) ONE_HOUR;
+  if (*tz == ':') {
+    if ((tz = parse_number(tz + 1, &value)) == 0 || value > 59) return (0);
+    *seconds += value * 60L;
+    if (*tz == ':') {
+      if ((tz = parse_number(tz + 1, &value)) == 0 || value > 59) return (0);
+      *seconds += value;
+    }
+  }
+  if (negative) *seconds = -*seconds;
+  return (tz);
+}
+
+static const char*
+parse_rule(const char* tz, zone_rule_t* rule)
+{
+  int16_t mon, week, wday;
+  int32_t seconds = 2 * ONE_HOUR;
+  if (*tz++ != 'M') return (0);
+  if ((tz = parse_number(tz, &mon)) == 0 || mon < 1 || mon > 12) return (0);
+  if (*tz++ != '.') return (0);
+  if ((tz = parse_number(tz, &week)) == 0 || week < 1 || week > 5) return (0);
+  if (*tz++ != '.') return (0);
+  if ((tz = parse_number(tz, &wday)) == 0 || wday > 6) return (0);
+  if (*tz == '/' && (tz = parse_time(tz + 1, &seconds)) == 0) return (0);
+  if ((seconds % 60) || seconds < -RULE_MAX || seconds > RULE_MAX)
+    return (0);
+  rule->mon = mon - 1;
+  rule->week = week;
+  rule->wday = wday;
+  rule->time = seconds / 60;
+  return (tz);
+}
+
+int
+zone_parse(zone_info_t* info, const char* tz)
+{
+  int32_t offset, dst;
+
+  // Standard time name and offset; POSIX offsets are West of UTC
+  memset(info, 0, sizeof(zone_info_t));
+  if ((tz = parse_name(tz)) == 0) return (-1);
+  if ((tz = parse_time(tz, &offset)) == 0) return (-1);
+  offset = -offset;
+  if ((offset % ONE_QUARTER) != 0) return (-1);
+  if (offset < -OFFSET_MAX || offset > OFFSET_MAX) return (-1);
+  info->offset = offset / ONE_QUARTER;
+  if (*tz == 0) return (0);
+
+  // Daylight Saving name and optional offset; default one hour
+  if ((tz = parse_name(tz)) == 0) return (-1);
+  dst = offset + ONE_HOUR;
+  if (*tz != 0 && *tz != ',') {
+    if ((tz = parse_time(tz, &dst)) == 0) return (-1);
+    dst = -dst;
+    if (dst < -OFFSET_MAX || dst > OFFSET_MAX) return (-1);
+  }
+  dst -= offset;
+  if (dst <= 0 || (dst % ONE_QUARTER) != 0) return (-1);
+  info->save = dst / ONE_QUARTER;
+
+  // Transition rules; default USA rules
+  if (*tz == 0) tz = ",M3.2.0,M11.1.0";
+  if (*tz++ != ',') return (-1);
+  if ((tz = parse_rule(tz, &info->start)) == 0) return (-1);
+  if (*tz++ != ',') return (-1);
+  if ((tz = parse_rule(tz, &info->end)) == 0) return (-1);
+  return (*tz == 0 ? 0 : -1);
+}
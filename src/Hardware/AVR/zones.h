@@ -0,0 +1,78 @@
+/**
+ * @file Hardware/AVR/zones.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef ZONES_H
+#define ZONES_H
+
+#include "time.h"
+#include <avr/pgmspace.h>
+
+/**
+ * Predefined time zone rules in program memory. To utilize these
+ * rules, you must \code #include "Hardware/AVR/zones.h" \endcode and
+ * \code zone_init_P(&zone, &zone_cet); \endcode Each rule is the
+ * compiled form of the POSIX TZ string in the comment. Other rules
+ * may be compiled with zone_parse().
+ */
+
+/** UTC0 */
+static const zone_info_t zone_utc PROGMEM = {
+  0, 0, { 0, 0, 0, 0 }, { 0, 0, 0, 0 }
+};
+
+/** GMT0BST,M3.5.0/1,M10.5.0 (London) */
+static const zone_info_t zone_gmt PROGMEM = {
+  0, 4, { MARCH, 5, SUNDAY, 60 }, { OCTOBER, 5, SUNDAY, 120 }
+};
+
+/** CET-1CEST,M3.5.0,M10.5.0/3 (Berlin, Paris, Stockholm) */
+static const zone_info_t zone_cet PROGMEM = {
+  4, 4, { MARCH, 5, SUNDAY, 120 }, { OCTOBER, 5, SUNDAY, 180 }
+};
+
+/** EET-2EEST,M3.5.0/3,M10.5.0/4 (Athens, Helsinki) */
+static const zone_info_t zone_eet PROGMEM = {
+  8, 4, { MARCH, 5, SUNDAY, 180 }, { OCTOBER, 5, SUNDAY, 240 }
+};
+
+/** EST5EDT,M3.2.0,M11.1.0 (New York) */
+static const zone_info_t zone_est PROGMEM = {
+  -20, 4, { MARCH, 2, SUNDAY, 120 }, { NOVEMBER, 1, SUNDAY, 120 }
+};
+
+/** CST6CDT,M3.2.0,M11.1.0 (Chicago) */
+static const zone_info_t zone_cst PROGMEM = {
+  -24, 4, { MARCH, 2, SUNDAY, 120 }, { NOVEMBER, 1, SUNDAY, 120 }
+};
+
+/** MST7MDT,M3.2.0,M11.1.0 (Denver) */
+static const zone_info_t zone_mst PROGMEM = {
+  -28, 4, { MARCH, 2, SUNDAY, 120 }, { NOVEMBER, 1, SUNDAY, 120 }
+};
+
+/** PST8PDT,M3.2.0,M11.1.0 (Los Angeles) */
+static const zone_info_t zone_pst PROGMEM = {
+  -32, 4, { MARCH, 2, SUNDAY, 120 }, { NOVEMBER, 1, SUNDAY, 120 }
+};
+
+/** AEST-10AEDT,M10.1.0,M4.1.0/3 (Sydney, Melbourne) */
+static const zone_info_t zone_aest PROGMEM = {
+  40, 4, { OCTOBER, 1, SUNDAY, 120 }, { APRIL, 1, SUNDAY, 180 }
+};
+
+#endif
@@ -68,6 +68,39 @@ enum {
  */
 #define isotime_r(tm,buf) (strftime (buf, 32, "%F %T", tm), buf)
 
+class __FlashStringHelper;
+
+/**
+ * Stream the broken-down time, formatted according to the given
+ * format string, to the given output, e.g. Serial. The output class
+ * should implement write(const uint8_t*, size_t). Formatted with
+ * strftime() into a buffer of 64 characters.
+ * @param[in] out output stream.
+ * @param[in] fmt format string.
+ * @param[in] timeptr broken-down time.
+ * @return number of characters.
+ */
+template<typename OUT>
+size_t strftime(OUT& out, const char* fmt, const struct tm* timeptr)
+{
+  char buf[64];
+  size_t n = strftime(buf, sizeof(buf), fmt, timeptr);
+  out.write((const uint8_t*) buf, n);
+  return (n);
+}
+
+/**
+ * Stream the broken-down time, formatted according to the given
+ * format string in program memory, to the given output. See
+ * strftime().
+ */
+template<typename OUT>
+size_t strftime(OUT& out, const __FlashStringHelper* fmt,
+		const struct tm* timeptr)
+{
+  return (strftime(out, (const char*) fmt, timeptr));
+}
+
 /**
  * Set the 'time zone'. The parameter is given in seconds East of the
  * Prime Meridian. Example for New York City: \code set_zone(-5 *
@@ -75,8 +108,148 @@ enum {
  *
  * If the time zone is not set, the time system will operate in UTC only.
  */
-#define set_zone(x) _timezone = x
-#define get_zone() _timezone
+inline void set_zone(int32_t offset)
+{
+  _timezone = offset;
+}
+
+inline int32_t get_zone()
+{
+  return (_timezone);
+}
+
+/**
+ * Time zone; standard time offset and Daylight Saving function, see
+ * set_dst() on AVR. Compiled zone rules are not supported. Conversion
+ * with a time zone object does not read the global time zone, and
+ * may be used from several threads with different time zones without
+ * locking.
+ */
+struct zone_t {
+  int32_t offset;			//!< Standard time, seconds East of UTC.
+  int (*dst)(const time_t*, int32_t*);	//!< Daylight Saving or null.
+};
+
+/**
+ * Set the standard time offset of the given time zone. The
+ * parameter is given in seconds East of the Prime Meridian.
+ */
+inline void set_zone(zone_t* zone, int32_t offset)
+{
+  zone->offset = offset;
+}
+
+/**
+ * Set the Daylight Saving function of the given time zone.
+ */
+inline void set_dst(zone_t* zone, int (*dst)(const time_t*, int32_t*))
+{
+  zone->dst = dst;
+}
+
+/**
+ * Return a copy of the global time zone, i.e. set_zone(), in the
+ * given time zone object.
+ */
+inline void get_zone(zone_t* zone)
+{
+  zone->offset = get_zone();
+  zone->dst = NULL;
+}
+
+/**
+ * Return Daylight Saving (seconds) in the given time zone for the
+ * time stamp (UTC) pointed to by timer, or -1 if the zone has no
+ * Daylight Saving function.
+ */
+inline int16_t zone_dst(const time_t* timer, zone_t* zone)
+{
+  int32_t offset = zone->offset;
+  return (zone->dst ? zone->dst(timer, &offset) : -1);
+}
+
+/**
+ * This function 'compiles' the elements of a broken-down time
+ * structure, returning a binary time stamp. The elements of timeptr
+ * are interpreted as representing UTC, and are not modified.
+ */
+inline time_t mk_gmtime(const struct tm* timeptr)
+{
+  // Days from 0000-03-01 in the proleptic Gregorian calendar
+  int32_t year = timeptr->tm_year + 1900L;
+  int32_t mon = timeptr->tm_mon;
+  year += mon / 12;
+  mon %= 12;
+  if (mon < 0) {
+    mon += 12;
+    year -= 1;
+  }
+  if (mon < MARCH) {
+    mon += 12;
+    year -= 1;
+  }
+  int32_t era = (year >= 0 ? year : year - 399) / 400;
+  int32_t yoe = year - era * 400;
+  int32_t doy = (153 * (mon - MARCH) + 2) / 5 + timeptr->tm_mday - 1;
+  int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  int32_t days = era * 146097L + doe - 719468L;
+  return ((time_t) days * ONE_DAY
+	  + timeptr->tm_hour * 3600L
+	  + timeptr->tm_min * 60L
+	  + timeptr->tm_sec);
+}
+
+/**
+ * Return seconds from midnight [0-86399] for the given time stamp.
+ */
+inline uint32_t time_of_day(time_t time)
+{
+  return (time % ONE_DAY);
+}
+
+/**
+ * Return day of week [0-6], days since Sunday, for the given time
+ * stamp (the UNIX epoch was a Thursday).
+ */
+inline uint8_t weekday(time_t time)
+{
+  return ((time / ONE_DAY + THURSDAY) % 7);
+}
+
+/**
+ * The localtime function converts the time stamp pointed to by timer
+ * into broken-down time, expressed as local time in the given time
+ * zone.
+ */
+inline struct tm* localtime_z(const time_t* timer, struct tm* timeptr,
+			      zone_t* zone)
+{
+  int dst = zone_dst(timer, zone);
+  time_t lt = *timer + zone->offset;
+  if (dst > 0) lt += dst;
+  gmtime_r(&lt, timeptr);
+  timeptr->tm_isdst = dst;
+  return (timeptr);
+}
+
+/**
+ * This function 'compiles' the elements of a broken-down time
+ * structure, interpreted as local time in the given time zone,
+ * returning a binary time stamp. The elements of timeptr are
+ * normalized.
+ */
+inline time_t mktime_z(struct tm* timeptr, zone_t* zone)
+{
+  time_t ret = mk_gmtime(timeptr);
+  if (timeptr->tm_isdst < 0) {
+    int32_t offset = zone->offset;
+    if (zone->dst) timeptr->tm_isdst = zone->dst(&ret, &offset);
+  }
+  if (timeptr->tm_isdst > 0) ret -= timeptr->tm_isdst;
+  ret -= zone->offset;
+  localtime_z(&ret, timeptr, zone);
+  return (ret);
+}
 
 /**
  * Software Real-Time Clock.
@@ -104,6 +277,33 @@ public:
     return (true);
   }
 
+  /**
+   * Increment seconds counter with the number of whole seconds
+   * elapsed since the previous update. The remaining milliseconds
+   * are carried forward to the next update.
+   * @return number of seconds applied.
+   */
+  uint32_t update()
+  {
+    uint32_t now = millis();
+    uint32_t ms = now - m_millis;
+    if (ms < 1000) return (0);
+    uint32_t seconds = ms / 1000;
+    m_time += seconds;
+    m_millis = now - (ms - seconds * 1000);
+    return (seconds);
+  }
+
+  /**
+   * Increment seconds counter. Should be called from an interrupt
+   * handler once per second, e.g. a timer compare interrupt. The
+   * clock then does not need tick() or update() calls.
+   */
+  void tick_isr()
+  {
+    m_time += 1;
+  }
+
   /**
    * Current time in seconds from epoch.
    * @return seconds from epoch.
@@ -139,9 +339,18 @@ public:
     set_time(mktime(&now) + get_zone());
   }
 
+  /**
+   * Set the current time based on the given time structure and
+   * time zone.
+   */
+  void set_time(struct tm& now, zone_t& zone)
+  {
+    set_time(mktime_z(&now, &zone) + zone.offset);
+  }
+
 protected:
   /** Timestamp for previous tick call. */
-  volatile uint16_t m_millis;
+  volatile uint32_t m_millis;
 
   /** Current time from epoch. */
   volatile time_t m_time;
@@ -0,0 +1,273 @@
+/**
+ * @file HybridRTC.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef HYBRID_RTC_H
+#define HYBRID_RTC_H
+
+#include "RTC.h"
+
+/**
+ * Hybrid Real-Time Clock; software clock seeded and periodically
+ * synchronized from a real-time clock device (DS1302 or DS1307).
+ * The device is only read on begin() and when the synchronization
+ * interval has elapsed. All other time reads are served by the
+ * software clock. On AVR the synchronizations are also used to
+ * calibrate the software clock trim. On AVR the software clock is
+ * never stepped backwards on synchronization. When it is ahead of
+ * the device it is slowed down with the trim until the difference
+ * has been absorbed. On other targets there is no trim, and the
+ * clock is stepped to the device time, also backwards. Use
+ * set_time() to step the clock. A failed device read is retried
+ * after the synchronization interval.
+ * @param[in] DEVICE real-time clock device driver class.
+ */
+template<typename DEVICE>
+class HybridRTC : public RTC {
+public:
+  /**
+   * Construct hybrid real-time clock with the given device and
+   * synchronization interval.
+   * @param[in] dev real-time clock device.
+   * @param[in] interval seconds between synchronization (default 1 hour).
+   */
+  HybridRTC(DEVICE& dev, uint32_t interval = ONE_HOUR) :
+    RTC(),
+    m_dev(dev),
+    m_interval(interval),
+    m_sync(0)
+#if defined(AVR)
+    , m_calibrator(*this),
+    m_slew(0),
+    m_slew_trim(0),
+    m_slewed(0)
+#endif
+  {}
+
+  using RTC::get_time;
+
+  /**
+   * Seed the software clock from the device. Return true(1) if
+   * successful otherwise false(0).
+   * @return bool.
+   */
+  bool begin()
+  {
+    struct tm now;
+    if (!m_dev.get_time(now)) return (false);
+    RTC::set_time(now);
+    restart();
+    return (true);
+  }
+
+  /**
+   * Increment seconds counter with the number of whole seconds
+   * elapsed since the previous update. Synchronize with the device
+   * when the interval has elapsed. Return number of seconds applied.
+   * @return seconds.
+   */
+  uint16_t update()
+  {
+    uint16_t seconds = RTC::update();
+    if (seconds == 0) return (0);
+#if defined(AVR)
+    if (m_slew != 0) slew(seconds);
+#endif
+    if ((get_time() - m_sync) >= m_interval) sync();
+    return (seconds);
+  }
+
+  /**
+   * Increment seconds counter when time has elapsed. See update().
+   * Return true(1) if an increment occured, otherwise false(0).
+   */
+  bool tick()
+  {
+    return (update() != 0);
+  }
+
+  /**
+   * Read the device and synchronize the software clock. The clock is
+   * stepped forward when behind the device, and on AVR slowed down
+   * when ahead. Return true(1) if successful otherwise false(0); the
+   * next synchronization is after the interval.
+   * @return bool.
+   */
+  bool sync()
+  {
+    struct tm now;
+    if (!m_dev.get_time(now)) {
+      m_sync = get_time();
+      return (false);
+    }
+    zone_t zone;
+    get_zone(&zone);
+    time_t time = mktime_z(&now, &zone) + zone.offset;
+    time_t current = get_time();
+    m_sync = time;
+#if defined(AVR)
+    slew_stop();
+    m_calibrator.update(m_sync);
+    if (time < current) slew_start(current - time);
+    if (time > current) RTC::set_time(time);
+#else
+    if (time != current) RTC::set_time(time);
+#endif
+    return (true);
+  }
+
+  /**
+   * Set the device and software clock to the given time (seconds)
+   * from epoch.
+   * @param[in] time seconds from epoch.
+   */
+  void set_time(time_t time)
+  {
+    struct tm now;
+    gmtime_r(&time, &now);
+    m_dev.set_time(now);
+    RTC::set_time(time);
+    restart();
+  }
+
+  /**
+   * Set the device and software clock based on the given time
+   * structure.
+   * @param[in] now time to set.
+   */
+  void set_time(struct tm& now)
+  {
+    m_dev.set_time(now);
+    RTC::set_time(now);
+    restart();
+  }
+
+  /**
+   * Set the device and software clock based on the given time
+   * structure and time zone.
+   * @param[in] now time to set.
+   * @param[in] zone time zone.
+   */
+  void set_time(struct tm& now, zone_t& zone)
+  {
+    m_dev.set_time(now);
+    RTC::set_time(now, zone);
+    restart();
+  }
+
+  /**
+   * Return synchronization interval (seconds).
+   * @return seconds.
+   */
+  uint32_t interval() const
+  {
+    return (m_interval);
+  }
+
+  /**
+   * Set synchronization interval (seconds).
+   * @param[in] seconds between synchronization.
+   */
+  void interval(uint32_t seconds)
+  {
+    m_interval = seconds;
+  }
+
+protected:
+  /** Real-time clock device. */
+  DEVICE& m_dev;
+
+  /** Seconds between synchronization. */
+  uint32_t m_interval;
+
+  /** Time of latest synchronization. */
+  time_t m_sync;
+
+#if defined(AVR)
+  /** Extra trim (ppm) to slow down the clock when ahead. */
+  static const int16_t SLEW_TRIM = 5000;
+
+  /** Calibration of the software clock against the device. */
+  Calibrator m_calibrator;
+
+  /** Seconds the software clock is ahead of the device. */
+  uint32_t m_slew;
+
+  /** Extra trim (ppm) applied while slowing down. */
+  int16_t m_slew_trim;
+
+  /** Micro-seconds absorbed of the next second. */
+  uint32_t m_slewed;
+
+  /**
+   * Start slowing down the software clock with the given number of
+   * seconds. The extra trim is added to the calibrated trim.
+   * @param[in] seconds ahead of the device.
+   */
+  void slew_start(uint32_t seconds)
+  {
+    int16_t base = trim();
+    trim(base + SLEW_TRIM);
+    m_slew_trim = trim() - base;
+    m_slew = (m_slew_trim > 0 ? seconds : 0);
+    m_slewed = 0;
+  }
+
+  /**
+   * Stop slowing down the software clock and restore the calibrated
+   * trim.
+   */
+  void slew_stop()
+  {
+    trim(trim() - m_slew_trim);
+    m_slew_trim = 0;
+    m_slew = 0;
+    m_slewed = 0;
+  }
+
+  /**
+   * Account the given number of elapsed seconds at the extra trim,
+   * and stop when the difference has been absorbed.
+   * @param[in] seconds elapsed.
+   */
+  void slew(uint16_t seconds)
+  {
+    m_slewed += (uint32_t) seconds * m_slew_trim;
+    while (m_slewed >= 1000000UL && m_slew != 0) {
+      m_slewed -= 1000000UL;
+      m_slew -= 1;
+    }
+    if (m_slew == 0) slew_stop();
+  }
+#endif
+
+  /**
+   * Restart synchronization interval and calibration after the time
+   * has been set.
+   */
+  void restart()
+  {
+    m_sync = get_time();
+#if defined(AVR)
+    slew_stop();
+    m_calibrator.reset();
+    m_calibrator.update(m_sync);
+#endif
+  }
+};
+
+#endif
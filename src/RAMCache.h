@@ -0,0 +1,182 @@
+/**
+ * @file RAMCache.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef RAM_CACHE_H
+#define RAM_CACHE_H
+
+#include <string.h>
+
+/**
+ * Write-back cache of the static memory of a real-time clock device
+ * (DS1302 or DS1307). The memory is mirrored and reads are served
+ * from the mirror. Writes only update the mirror, and the range of
+ * changed bytes. The range is written to the device with a single
+ * block transfer on flush(). On DS1302 the block is extended to
+ * address zero when a burst transfer is shorter than single byte
+ * writes. The cache has the same memory access functions as the
+ * device drivers, and may be used in their place, e.g. with Record.
+ * @param[in] DEVICE real-time clock device driver class.
+ * @param[in] SIZE number of bytes to cache (default DEVICE::RAM_MAX).
+ */
+template<typename DEVICE, size_t SIZE = DEVICE::RAM_MAX>
+class RAMCache {
+public:
+  /** Static memory size. */
+  static const size_t RAM_MAX = SIZE;
+
+  /**
+   * Construct cache for the given device and memory address.
+   * @param[in] dev real-time clock device.
+   * @param[in] addr memory address on the device (default
+   *   DEVICE::RAM_START).
+   */
+  RAMCache(DEVICE& dev, uint8_t addr = DEVICE::RAM_START) :
+    m_dev(dev),
+    m_addr(addr),
+    m_first(SIZE),
+    m_last(0)
+  {
+    memset(m_buf, 0, sizeof(m_buf));
+  }
+
+  /**
+   * Read device memory into the cache. Pending writes are
+   * discarded. Return true(1) if successful otherwise false(0).
+   * @return bool.
+   */
+  bool begin()
+  {
+    m_first = SIZE;
+    return (m_dev.read_ram(m_addr, m_buf, SIZE));
+  }
+
+  /**
+   * Return true(1) if there are pending writes, otherwise false(0).
+   * @return bool.
+   */
+  bool is_dirty() const
+  {
+    return (m_first < SIZE);
+  }
+
+  /**
+   * Return byte at given cached memory address.
+   * @param[in] addr memory address (0..RAM_MAX-1).
+   * @return data.
+   */
+  uint8_t read_ram(uint8_t addr) const
+  {
+    return (addr < SIZE ? m_buf[addr] : 0);
+  }
+
+  /**
+   * Write given byte to cached memory address.
+   * @param[in] addr memory address (0..RAM_MAX-1).
+   * @param[in] data to write.
+   */
+  void write_ram(uint8_t addr, uint8_t data)
+  {
+    write_ram(addr, &data, sizeof(data));
+  }
+
+  /**
+   * Read memory block with the given size from the given cached
+   * memory address into the buffer. Return true(1) if successful
+   * otherwise false(0); block outside cache.
+   * @param[in] addr memory address (0..RAM_MAX-1).
+   * @param[in] buf buffer to store data read.
+   * @param[in] count number of bytes to read.
+   * @return bool.
+   */
+  bool read_ram(uint8_t addr, void* buf, size_t count) const
+  {
+    if (addr + count > SIZE) return (false);
+    memcpy(buf, &m_buf[addr], count);
+    return (true);
+  }
+
+  /**
+   * Write memory block with the given size to the given cached
+   * memory address. Only changed bytes are marked for write back.
+   * Return true(1) if successful otherwise false(0); block outside
+   * cache.
+   * @param[in] addr memory address (0..RAM_MAX-1).
+   * @param[in] buf buffer with data to write.
+   * @param[in] count number of bytes to write.
+   * @return bool.
+   */
+  bool write_ram(uint8_t addr, const void* buf, size_t count)
+  {
+    if (addr + count > SIZE) return (false);
+    const uint8_t* bp = (const uint8_t*) buf;
+    for (; count != 0; count--, addr++, bp++) {
+      if (m_buf[addr] == *bp) continue;
+      m_buf[addr] = *bp;
+      if (!is_dirty()) {
+	m_first = addr;
+	m_last = addr;
+      }
+      else if (addr < m_first) m_first = addr;
+      else if (addr > m_last) m_last = addr;
+    }
+    return (true);
+  }
+
+  /**
+   * Write pending changes to the device. Return true(1) if
+   * successful otherwise false(0); the changes are kept pending.
+   * @return bool.
+   */
+  bool flush()
+  {
+    if (!is_dirty()) return (true);
+    uint8_t first = m_first;
+    uint8_t count = m_last - first + 1;
+
+    // Burst from address zero when shorter than single byte writes;
+    // command byte and data byte per write, one command byte per burst
+    if (DEVICE::RAM_BURST_ZERO && m_addr == 0 && first != 0
+	&& m_last + 2 <= 2 * count) {
+      first = 0;
+      count = m_last + 1;
+    }
+    if (!m_dev.write_ram(m_addr + first, &m_buf[first], count))
+      return (false);
+    m_first = SIZE;
+    m_last = 0;
+    return (true);
+  }
+
+protected:
+  /** Real-time clock device. */
+  DEVICE& m_dev;
+
+  /** Memory address of cache on the device. */
+  uint8_t m_addr;
+
+  /** First changed byte; SIZE when none. */
+  uint8_t m_first;
+
+  /** Last changed byte. */
+  uint8_t m_last;
+
+  /** Mirror of device memory. */
+  uint8_t m_buf[SIZE];
+};
+
+#endif
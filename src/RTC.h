@@ -21,7 +21,9 @@
 #include "bcd.h"
 #if defined(AVR)
 #include "Hardware/AVR/time.h"
+#include "Hardware/AVR/Calendar.h"
 #include "Hardware/AVR/RTC.h"
+#include "Hardware/AVR/CalendarRTC.h"
 #elif defined(SAM)
 #include "Hardware/SAM/RTC.h"
 #endif
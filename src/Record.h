@@ -0,0 +1,211 @@
+/**
+ * @file Record.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <string.h>
+
+/**
+ * Record store in the static memory of a real-time clock device
+ * (DS1302 or DS1307). The record is kept in two slots with sequence
+ * number and CRC. A commit is written to the older slot so that the
+ * latest committed record is intact if the write is interrupted,
+ * e.g. by a brownout. Only the bytes from the first changed byte to
+ * the end of the slot are written; the sequence number and CRC are
+ * last in the slot, and written in the same block. Both slots are
+ * mirrored in memory, so commit does not need to read the device.
+ * @param[in] DEVICE real-time clock device driver class.
+ * @param[in] T record type.
+ */
+template<typename DEVICE, typename T>
+class Record {
+public:
+  /**
+   * Construct record store on the given device at the given memory
+   * address. The store requires SIZE bytes.
+   * @param[in] dev real-time clock device.
+   * @param[in] addr memory address on the device, e.g.
+   *   DEVICE::RAM_START.
+   */
+  Record(DEVICE& dev, uint8_t addr) :
+    m_dev(dev),
+    m_addr(addr),
+    m_active(1),
+    m_valid(0)
+  {
+    memset(&m_data, 0, sizeof(m_data));
+    memset(m_slot, 0, sizeof(m_slot));
+  }
+
+  /**
+   * Read both slots from the device and restore the latest valid
+   * record. Return true(1) if a valid record was found, otherwise
+   * false(0); the record is then left unchanged.
+   * @return bool.
+   */
+  bool begin()
+  {
+    m_valid = 0;
+    for (uint8_t i = 0; i < 2; i++) {
+      if (!m_dev.read_ram(address(i), &m_slot[i], sizeof(slot_t)))
+	continue;
+      if (m_slot[i].crc == crc(&m_slot[i])) m_valid |= (1 << i);
+    }
+    if (m_valid == 0) return (false);
+    if (m_valid == 3)
+      m_active = ((int8_t) (m_slot[1].seq - m_slot[0].seq) > 0);
+    else
+      m_active = (m_valid == 2);
+    m_data = m_slot[m_active].data;
+    return (true);
+  }
+
+  /**
+   * Return reference to the record. Changes are written to the
+   * device on commit().
+   * @return record.
+   */
+  T& data()
+  {
+    return (m_data);
+  }
+
+  /**
+   * Write the record to the device if it has changed since the
+   * latest commit. Return true(1) if successful otherwise false(0);
+   * the latest committed record is then still valid on the device.
+   * @return bool.
+   */
+  bool commit()
+  {
+    if ((m_valid & (1 << m_active))
+	&& !memcmp(&m_data, &m_slot[m_active].data, sizeof(T)))
+      return (true);
+
+    // Find the first changed byte in the older slot
+    uint8_t slot = m_active ^ 1;
+    uint8_t first = 0;
+    if (m_valid & (1 << slot)) {
+      const uint8_t* dp = (const uint8_t*) &m_data;
+      const uint8_t* sp = (const uint8_t*) &m_slot[slot].data;
+      while (first < sizeof(T) && dp[first] == sp[first]) first++;
+    }
+
+    // Write changed bytes, sequence number and CRC in one block
+    m_slot[slot].data = m_data;
+    m_slot[slot].seq = m_slot[m_active].seq + 1;
+    m_slot[slot].crc = crc(&m_slot[slot]);
+    const uint8_t* bp = ((const uint8_t*) &m_slot[slot]) + first;
+    if (!m_dev.write_ram(address(slot) + first, bp, sizeof(slot_t) - first)) {
+      m_valid &= ~(1 << slot);
+      return (false);
+    }
+    m_valid |= (1 << slot);
+    m_active = slot;
+    return (true);
+  }
+
+  /**
+   * Restore the record from the latest commit. Return true(1) if
+   * successful otherwise false(0); no valid record.
+   * @return bool.
+   */
+  bool rollback()
+  {
+    if ((m_valid & (1 << m_active)) == 0) return (false);
+    m_data = m_slot[m_active].data;
+    return (true);
+  }
+
+  /**
+   * Return sequence number of the latest commit.
+   * @return sequence number.
+   */
+  uint8_t sequence() const
+  {
+    return (m_slot[m_active].seq);
+  }
+
+protected:
+  /**
+   * Record slot; sequence number and CRC last so that they are
+   * always written together with the changed bytes.
+   */
+  struct slot_t {
+    T data;			//!< Record.
+    uint8_t seq;		//!< Sequence number.
+    uint8_t crc;		//!< CRC-8 of record and sequence number.
+  } __attribute__((packed));
+
+public:
+  /** Size of store in device memory (bytes). */
+  static const size_t SIZE = 2 * sizeof(slot_t);
+
+  static_assert(SIZE <= DEVICE::RAM_MAX, "record too large for device memory");
+
+protected:
+  /** Real-time clock device. */
+  DEVICE& m_dev;
+
+  /** Memory address of store on the device. */
+  uint8_t m_addr;
+
+  /** Index of slot with latest commit. */
+  uint8_t m_active;
+
+  /** Slots with valid contents (bit set). */
+  uint8_t m_valid;
+
+  /** Current record. */
+  T m_data;
+
+  /** Mirror of device slots. */
+  slot_t m_slot[2];
+
+  /**
+   * Return memory address on the device of the given slot.
+   * @param[in] slot index.
+   * @return address.
+   */
+  uint8_t address(uint8_t slot) const
+  {
+    return (m_addr + (slot ? sizeof(slot_t) : 0));
+  }
+
+  /**
+   * Return CRC-8 (Dallas/Maxim) of the record and sequence number in
+   * the given slot. The CRC is seeded with 0xff so that a cleared
+   * slot, all zero, is not valid.
+   * @param[in] sp slot.
+   * @return crc.
+   */
+  static uint8_t crc(const slot_t* sp)
+  {
+    const uint8_t* bp = (const uint8_t*) sp;
+    uint8_t res = 0xff;
+    for (size_t i = 0; i < sizeof(slot_t) - 1; i++) {
+      res ^= *bp++;
+      for (uint8_t j = 0; j < 8; j++)
+	res = (res & 1) ? (res >> 1) ^ 0x8c : (res >> 1);
+    }
+    return (res);
+  }
+};
+
+#endif
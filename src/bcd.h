@@ -19,6 +19,19 @@
 #ifndef BCD_H
 #define BCD_H
 
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+/**
+ * Configuration: Use table lookup in program memory for conversion
+ * to BCD (100 bytes). Define as zero(0) for the arithmetic
+ * (multiply and shift) conversion. May be defined before including
+ * the library.
+ */
+#ifndef BCD_TABLE
+#define BCD_TABLE 0
+#endif
+
 /**
  * BCD to integer conversion handling.
  */
@@ -34,13 +47,11 @@ struct bcd_t {
    */
   bcd_t(uint8_t value)
   {
-    uint8_t high = 0;
-    uint8_t low = value;
-    while (low > 9) {
-      high += 0x10;
-      low -= 10;
-    }
-    m_value = high + low;
+#if BCD_TABLE
+    m_value = encode_table(value);
+#else
+    m_value = encode(value);
+#endif
   }
 
   /**
@@ -49,14 +60,103 @@ struct bcd_t {
    */
   operator uint8_t()
   {
-    uint8_t high = (m_value & 0xf0);
-    uint8_t low = (m_value & 0x0f);
+    return (decode(m_value));
+  }
+
+  /**
+   * Return true(1) if both digits are in range (0..9), otherwise
+   * false(0).
+   * @return bool.
+   */
+  bool is_valid() const
+  {
+    return (((m_value & 0x0f) < 10) && (m_value < 0xa0));
+  }
+
+  /**
+   * Convert given value (0..99) to BCD with multiply and shift.
+   * @param[in] value as integer.
+   * @return BCD value.
+   */
+  static uint8_t encode(uint8_t value)
+  {
+    uint8_t high = (value * 205U) >> 11;
+    uint8_t low = value - high * 10;
+    return ((high << 4) + low);
+  }
+
+  /**
+   * Convert given value (0..99) to BCD with table lookup in program
+   * memory.
+   * @param[in] value as integer.
+   * @return BCD value.
+   */
+  static uint8_t encode_table(uint8_t value);
+
+  /**
+   * Convert given BCD value to integer.
+   * @param[in] value BCD value.
+   * @return integer.
+   */
+  static uint8_t decode(uint8_t value)
+  {
+    uint8_t high = (value & 0xf0);
+    uint8_t low = (value & 0x0f);
     return ((high >> 1) + (high >> 3) + low);
   }
 
+  /**
+   * Convert block of BCD values to integers in one pass. Return
+   * mask with bit i set if BCD value i has a digit out of range,
+   * i.e. zero(0) if all values are valid. Max 8 values are checked.
+   * @param[out] dest integer values.
+   * @param[in] src BCD values.
+   * @param[in] count number of values.
+   * @return mask of invalid values.
+   */
+  static uint8_t decode(uint8_t* dest, const bcd_t* src, uint8_t count)
+  {
+    uint8_t invalid = 0;
+    uint8_t mask = 0x01;
+    for (uint8_t i = 0; i < count; i++, mask <<= 1) {
+      if (!src[i].is_valid()) invalid |= mask;
+      dest[i] = decode(src[i].m_value);
+    }
+    return (invalid);
+  }
+
+  /**
+   * Convert block of integers (0..99) to BCD values in one pass.
+   * @param[out] dest BCD values.
+   * @param[in] src integer values.
+   * @param[in] count number of values.
+   */
+  static void encode(bcd_t* dest, const uint8_t* src, uint8_t count)
+  {
+    for (uint8_t i = 0; i < count; i++) dest[i] = bcd_t(src[i]);
+  }
+
 private:
   uint8_t m_value;
 } __attribute__((packed));
 
+/** Table with BCD values for 0..99 in program memory. */
+static const uint8_t bcd_table[100] PROGMEM = {
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,
+  0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29,
+  0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+  0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+  0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+  0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+  0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79,
+  0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+  0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99
+};
+
+inline uint8_t bcd_t::encode_table(uint8_t value)
+{
+  return (pgm_read_byte(&bcd_table[value]));
+}
 
 #endif